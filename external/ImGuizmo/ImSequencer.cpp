@@ -29,6 +29,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <float.h>
+#include <cstring>
 
 namespace ImSequencer
 {
@@ -52,6 +53,79 @@ namespace ImSequencer
       return overDel;
    }
 
+   // vertices of a draw list segment that only changes with the view, kept relative to an origin so they can be
+   // replayed while the inputs in the key stay the same
+   struct CachedLayer
+   {
+      static const int KeySize = 16;
+      float key[KeySize] = {};
+      bool valid = false;
+
+      ImVector<ImDrawVert> vtx;
+      ImVector<ImDrawIdx> idx;
+
+      int vtxStart = 0;
+      int idxStart = 0;
+      int cmdCount = 0;
+      unsigned int vtxBase = 0;
+      unsigned int vtxOffset = 0;
+   };
+
+   struct SequenceLayers
+   {
+      CachedLayer header;
+      CachedLayer content;
+   };
+
+   static bool ReplayLayer(CachedLayer& layer, ImDrawList* draw_list, const float* key, ImVec2 origin)
+   {
+      if (!layer.valid || memcmp(layer.key, key, sizeof(layer.key)) != 0)
+         return false;
+
+      draw_list->PrimReserve(layer.idx.Size, layer.vtx.Size);
+      unsigned int vtxBase = draw_list->_VtxCurrentIdx;
+      for (const ImDrawVert& v : layer.vtx)
+      {
+         ImDrawVert* out = draw_list->_VtxWritePtr++;
+         *out = v;
+         out->pos.x += origin.x;
+         out->pos.y += origin.y;
+      }
+      for (ImDrawIdx i : layer.idx)
+         *draw_list->_IdxWritePtr++ = (ImDrawIdx)(vtxBase + i);
+      draw_list->_VtxCurrentIdx += layer.vtx.Size;
+      return true;
+   }
+
+   static void BeginLayer(CachedLayer& layer, ImDrawList* draw_list)
+   {
+      layer.vtxStart = draw_list->VtxBuffer.Size;
+      layer.idxStart = draw_list->IdxBuffer.Size;
+      layer.cmdCount = draw_list->CmdBuffer.Size;
+      layer.vtxBase = draw_list->_VtxCurrentIdx;
+      layer.vtxOffset = draw_list->_CmdHeader.VtxOffset;
+   }
+
+   static void EndLayer(CachedLayer& layer, ImDrawList* draw_list, const float* key, ImVec2 origin)
+   {
+      // a segment split across draw commands can't be replayed into a single one
+      layer.valid = draw_list->CmdBuffer.Size == layer.cmdCount && draw_list->_CmdHeader.VtxOffset == layer.vtxOffset;
+      if (!layer.valid)
+         return;
+
+      memcpy(layer.key, key, sizeof(layer.key));
+      layer.vtx.resize(draw_list->VtxBuffer.Size - layer.vtxStart);
+      layer.idx.resize(draw_list->IdxBuffer.Size - layer.idxStart);
+      for (int i = 0; i < layer.vtx.Size; i++)
+      {
+         layer.vtx[i] = draw_list->VtxBuffer[layer.vtxStart + i];
+         layer.vtx[i].pos.x -= origin.x;
+         layer.vtx[i].pos.y -= origin.y;
+      }
+      for (int i = 0; i < layer.idx.Size; i++)
+         layer.idx[i] = (ImDrawIdx)(draw_list->IdxBuffer[layer.idxStart + i] - layer.vtxBase);
+   }
+
    bool Sequencer(SequenceInterface* sequence, double zoom, int currentBeatsplit, int beatsPerMeasure, bool darkTheme, bool haveSelection, bool windowFocused, bool* expanded,
                   bool* updatedBeat, bool* leftClickedEntity, bool* leftClickReleased, bool* leftClickShift, bool* rightClickedEntity, double* clickedBeat,
                   double* hoveredBeat, int* clickedItemType, int* releasedItemType, int* selectedEntry, double* firstFrame, int sequenceOptions)
@@ -84,6 +158,8 @@ namespace ImSequencer
       ImGui::BeginGroup();
 
       ImDrawList* draw_list = ImGui::GetWindowDrawList();
+      if (!sequence->layers)
+         sequence->layers = std::make_shared<SequenceLayers>();
       ImVec2 canvas_pos = ImGui::GetCursorScreenPos();            // ImDrawList API uses screen coordinates!
       ImVec2 canvas_size = ImGui::GetContentRegionAvail();        // Resize canvas to what's available
       float firstFrameUsed = firstFrame ? *firstFrame : 0;
@@ -260,12 +336,25 @@ namespace ImSequencer
                draw_list->AddLine(ImVec2(px, tiretStart), ImVec2(px, tiretEnd), 0x30606060, 1);
             }
          };
-         for (int i = sequence->GetFrameMin(); i <= sequence->GetFrameMax(); i += frameStep)
+
+         // the grid and its labels depend only on the view, so they are rebuilt only when it changes
+         const ImVec4 clipRect = draw_list->_ClipRectStack.back();
+         float headerKey[CachedLayer::KeySize] = { framePixelWidth, (float)firstFrameUsed, canvas_size.x, canvas_size.y,
+            (float)sequence->GetFrameMin(), (float)sequence->GetFrameMax(), (float)modFrameCount, (float)halfModFrameCount,
+            (float)frameStep, (float)legendWidth, darkTheme ? 1.f : 0.f,
+            clipRect.x - canvas_pos.x, clipRect.y - canvas_pos.y, clipRect.z - canvas_pos.x, clipRect.w - canvas_pos.y };
+         CachedLayer& headerLayer = sequence->layers->header;
+         if (!ReplayLayer(headerLayer, draw_list, headerKey, canvas_pos))
          {
-            drawLine(i, ItemHeight);
+            BeginLayer(headerLayer, draw_list);
+            for (int i = sequence->GetFrameMin(); i <= sequence->GetFrameMax(); i += frameStep)
+            {
+               drawLine(i, ItemHeight);
+            }
+            drawLine(sequence->GetFrameMin(), ItemHeight);
+            drawLine(sequence->GetFrameMax(), ItemHeight);
+            EndLayer(headerLayer, draw_list, headerKey, canvas_pos);
          }
-         drawLine(sequence->GetFrameMin(), ItemHeight);
-         drawLine(sequence->GetFrameMax(), ItemHeight);
          /*
                   draw_list->AddLine(canvas_pos, ImVec2(canvas_pos.x, canvas_pos.y + controlHeight), 0xFF000000, 1);
                   draw_list->AddLine(ImVec2(canvas_pos.x, canvas_pos.y + ItemHeight), ImVec2(canvas_size.x, canvas_pos.y + ItemHeight), 0xFF000000, 1);
@@ -421,13 +510,25 @@ namespace ImSequencer
 
          draw_list->PushClipRect(childFramePos + ImVec2(float(legendWidth), 0.f), childFramePos + childFrameSize);
 
+         sequence->DrawBackground(draw_list, ImRect(ImVec2(contentMin.x + legendWidth, contentMin.y), ImVec2(canvas_pos.x + canvas_size.x, contentMax.y)),
+            firstFrameUsed, framePixelWidth, darkTheme);
+
          // vertical frame lines in content area
-         for (int i = sequence->GetFrameMin(); i <= sequence->GetFrameMax(); i += frameStep)
+         float contentKey[CachedLayer::KeySize] = { framePixelWidth, (float)firstFrameUsed, canvas_size.x, canvas_size.y,
+            (float)sequence->GetFrameMin(), (float)sequence->GetFrameMax(), (float)frameStep, (float)legendWidth,
+            contentMin.x - canvas_pos.x, contentMin.y - canvas_pos.y, contentMax.y - canvas_pos.y };
+         CachedLayer& contentLayer = sequence->layers->content;
+         if (!ReplayLayer(contentLayer, draw_list, contentKey, canvas_pos))
          {
-            drawLineContent(i, int(contentHeight));
+            BeginLayer(contentLayer, draw_list);
+            for (int i = sequence->GetFrameMin(); i <= sequence->GetFrameMax(); i += frameStep)
+            {
+               drawLineContent(i, int(contentHeight));
+            }
+            drawLineContent(sequence->GetFrameMin(), int(contentHeight));
+            drawLineContent(sequence->GetFrameMax(), int(contentHeight));
+            EndLayer(contentLayer, draw_list, contentKey, canvas_pos);
          }
-         drawLineContent(sequence->GetFrameMin(), int(contentHeight));
-         drawLineContent(sequence->GetFrameMax(), int(contentHeight));
 
          // selection
          bool selected = selectedEntry && (*selectedEntry >= 0);
@@ -451,14 +552,16 @@ namespace ImSequencer
             }
          }
 
-         // draw the sequence items
-         for (int i = 0; i < sequence->GetItemCount(); i++)
+         // draw the sequence items, fetching only those within the view (items reach 3 px left and 29 px right of their frames)
+         static std::vector<SequenceItem> visibleItems;
+         sequence->GetItems(firstFrameUsed - 32.f / framePixelWidth, firstFrameUsed + visibleFrameCount + 3.f / framePixelWidth, visibleItems);
+         for (const auto& visibleItem : visibleItems)
          {
-            double* start, * end;
-            int itemType;
+            int i = visibleItem.index;
+            double* start = visibleItem.start, * end = visibleItem.end;
+            int itemType = visibleItem.type;
             unsigned int color = darkTheme ? 0xFFAA8080 : 0xFFBAD4F3;
-            const char * displayText;
-            sequence->Get(i, &start, &end, &itemType, nullptr, &displayText);
+            const char * displayText = visibleItem.displayText;
             size_t localCustomHeight = sequence->GetCustomHeight(i);
 
             customHeight = localCustomHeight * itemType;
@@ -478,6 +581,10 @@ namespace ImSequencer
             if (slotP1.x <= (canvas_size.x + contentMin.x) && slotP2.x >= (contentMin.x + legendWidth))
             {
                draw_list->AddRectFilled(slotP1, slotP2, slotColor, 2);
+               if (visibleItem.selected)
+               {
+                  draw_list->AddRect(slotP1, slotP2, darkTheme ? 0xFF40C0FF : 0xFF0060E0, 2, 0, 2.f);
+               }
             }
             if (ImRect(slotP1, slotP2).Contains(io.MousePos) && io.MouseDoubleClicked[0])
             {
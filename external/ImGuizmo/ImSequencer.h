@@ -26,6 +26,8 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 struct ImDrawList;
 struct ImRect;
@@ -42,9 +44,24 @@ namespace ImSequencer
       SEQUENCER_EDIT_ALL = SEQUENCER_EDIT_STARTEND | SEQUENCER_CHANGE_FRAME
    };
 
+   // an item handed to the sequencer in a batch, with its index for the per-item callbacks
+   struct SequenceItem
+   {
+      int index;
+      double* start;
+      double* end;
+      int type;
+      const char* displayText;
+      bool selected;
+   };
+
+   struct SequenceLayers;
+
    struct SequenceInterface
    {
       bool focused = false;
+      // draw layers the sequencer caches for this sequence, so several visible sequences don't evict each other
+      std::shared_ptr<SequenceLayers> layers;
       virtual int GetFrameMin() const = 0;
       virtual int GetFrameMax() const = 0;
       virtual int GetItemCount() const = 0;
@@ -57,6 +74,18 @@ namespace ImSequencer
       virtual const char* GetCollapseFmt() const { return "%d Frames / %d entries"; }
 
       virtual void Get(int index, double** start, double** end, int* type, unsigned int* color, const char ** displayText) = 0;
+      // the items overlapping [firstFrame, lastFrame]; the default visits every item through Get
+      virtual void GetItems(double firstFrame, double lastFrame, std::vector<SequenceItem>& items)
+      {
+         items.clear();
+         for (int i = 0; i < GetItemCount(); i++)
+         {
+            SequenceItem item = { i, nullptr, nullptr, 0, "", false };
+            Get(i, &item.start, &item.end, &item.type, nullptr, &item.displayText);
+            if (*item.end >= firstFrame && *item.start <= lastFrame)
+               items.push_back(item);
+         }
+      }
       virtual void Add(int /*type*/) {}
       virtual void Del(int /*index*/) {}
       virtual void Duplicate(int /*index*/) {}
@@ -68,6 +97,8 @@ namespace ImSequencer
       virtual void DoubleClick(int /*index*/) {}
       virtual void CustomDraw(int /*index*/, ImDrawList* /*draw_list*/, const ImRect& /*rc*/, const ImRect& /*legendRect*/, const ImRect& /*clippingRect*/, const ImRect& /*legendClippingRect*/) {}
       virtual void CustomDrawCompact(int /*index*/, ImDrawList* /*draw_list*/, const ImRect& /*rc*/, const ImRect& /*clippingRect*/) {}
+      // drawn over the lane backgrounds, before frame lines and items
+      virtual void DrawBackground(ImDrawList* /*draw_list*/, const ImRect& /*rc*/, double /*firstFrame*/, float /*framePixelWidth*/, bool /*darkTheme*/) {}
    };
 
 
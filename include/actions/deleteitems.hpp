@@ -12,6 +12,7 @@ class DeleteItemsAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
     private:
         int itemTypeStart;
         int itemTypeEnd;
@@ -10,6 +10,7 @@ class DeleteNoteAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
 
     private:
         double absBeat;
@@ -0,0 +1,21 @@
+#ifndef DELETESELECTION_HPP
+#define DELETESELECTION_HPP
+
+#include <list>
+#include <memory>
+
+#include "actions/editaction.hpp"
+#include "config/notesequenceitem.hpp"
+
+class DeleteSelectionAction : public EditAction {
+    public:
+        explicit DeleteSelectionAction(const std::list<std::shared_ptr<NoteSequenceItem>> & items);
+
+        void undoAction(EditWindow * editWindow) override;
+        void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
+    private:
+        std::list<std::shared_ptr<NoteSequenceItem>> items;
+};
+
+#endif // DELETESELECTION_HPP
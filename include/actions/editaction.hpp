@@ -1,6 +1,8 @@
 #ifndef EDITACTION_HPP
 #define EDITACTION_HPP
 
+#include <cstddef>
+
 class EditWindow;
 
 class EditAction {
@@ -10,6 +12,9 @@ public:
 
     virtual void undoAction(EditWindow * editWindow) = 0;
     virtual void redoAction(EditWindow * editWindow) = 0;
+
+    // bytes held by the action, for memory accounting
+    virtual size_t getMemoryUsage() const = 0;
 };
 
 #endif // EDITACTION_HPP
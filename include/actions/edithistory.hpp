@@ -0,0 +1,42 @@
+#ifndef EDITHISTORY_HPP
+#define EDITHISTORY_HPP
+
+#include <deque>
+#include <memory>
+
+#include "actions/editaction.hpp"
+
+// the undo and redo stacks as one log: actions before the cursor can be undone, those after it redone.
+// once the log holds more than its byte budget the oldest actions are forgotten
+class EditHistory {
+    public:
+        // drops anything that could be redone
+        void push(const std::shared_ptr<EditAction> & action, size_t byteBudget);
+
+        bool undo(EditWindow * editWindow);
+        bool redo(EditWindow * editWindow);
+
+        size_t getUndoCount() const;
+        size_t getRedoCount() const;
+
+        // counts every action ever applied, so it still identifies a state after old actions are forgotten
+        size_t getPosition() const;
+
+        size_t getMemoryUsage() const;
+    private:
+        struct Entry {
+            std::shared_ptr<EditAction> action;
+
+            // measured when pushed and whenever applied, as items change hands between the chart and the log
+            size_t bytes;
+        };
+
+        void measure(Entry & entry);
+
+        std::deque<Entry> entries;
+        size_t cursor { 0 };
+        size_t forgotten { 0 };
+        size_t bytes { 0 };
+};
+
+#endif // EDITHISTORY_HPP
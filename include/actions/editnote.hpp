@@ -13,6 +13,7 @@ class EditNoteAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
 
     private:
         double absBeat;
@@ -10,6 +10,7 @@ class EditSkipAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
 
     private:
         double absBeat;
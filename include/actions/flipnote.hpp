@@ -1,25 +1,25 @@
 #ifndef FLIPNOTE_HPP
 #define FLIPNOTE_HPP
 
+#include <list>
+#include <memory>
 #include <string>
 #include <string_view>
 
 #include "actions/editaction.hpp"
+#include "config/notesequenceitem.hpp"
 
 class FlipNoteAction : public EditAction {
     public:
-        FlipNoteAction(int minItemType, int maxItemType, double startBeat, double endBeat, std::string_view keyboardLayout);
+        FlipNoteAction(std::string_view keyboardLayout, const std::list<std::shared_ptr<NoteSequenceItem>> & items);
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
     private:
-        int minItemType;
-        int maxItemType;
-
-        double startBeat;
-        double endBeat;
-
         std::string keyboardLayout;
+
+        std::list<std::shared_ptr<NoteSequenceItem>> items;
 };
 
 #endif // FLIPNOTE_HPP
@@ -14,6 +14,7 @@ class InsertItemsAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
     private:
         int itemTypeStart;
         int itemTypeEnd;
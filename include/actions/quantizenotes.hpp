@@ -0,0 +1,36 @@
+#ifndef QUANTIZENOTES_HPP
+#define QUANTIZENOTES_HPP
+
+#include <memory>
+#include <vector>
+
+#include "actions/editaction.hpp"
+#include "config/beatpos.hpp"
+#include "config/notesequenceitem.hpp"
+
+class QuantizeNotesAction : public EditAction {
+    public:
+        struct Move {
+            std::shared_ptr<NoteSequenceItem> item;
+
+            double fromBeat;
+            double fromBeatEnd;
+            BeatPos fromBeatpos;
+            BeatPos fromEndBeatpos;
+
+            double toBeat;
+            double toBeatEnd;
+            BeatPos toBeatpos;
+            BeatPos toEndBeatpos;
+        };
+
+        explicit QuantizeNotesAction(const std::vector<Move> & moves);
+
+        void undoAction(EditWindow * editWindow) override;
+        void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
+    private:
+        std::vector<Move> moves;
+};
+
+#endif // QUANTIZENOTES_HPP
@@ -24,6 +24,7 @@ class ShiftNoteAction : public EditAction {
 
         void undoAction(EditWindow * editWindow) override;
         void redoAction(EditWindow * editWindow) override;
+        size_t getMemoryUsage() const override;
     private:
         int minItemType;
         int maxItemType;
@@ -11,6 +11,7 @@ namespace fs = std::filesystem;
 namespace constants {
     // song metadata
     const std::string SONGINFO_FILENAME = "songinfo.json";
+    const std::string WAVEFORM_CACHE_EXTENSION = ".peaks";
 
     const std::string TITLE_KEY = "title";
     const std::string ARTIST_KEY = "artist";
@@ -60,10 +61,18 @@ namespace constants {
     const double SKIPTIME_VALUE_DEFAULT = 0.0;
 
     constexpr double ZOOM_STEP = 0.25;
+    constexpr float MINIMAP_LANE_HEIGHT = 5.f;
+
+    constexpr std::array<double, 6> PLAYBACK_RATES { 0.25, 0.5, 0.75, 1.0, 1.25, 1.5 };
 
     constexpr int BEATS_PER_MEASURE_VALUE_DEFAULT = 4;
     constexpr int NOTE_TYPE_VALUE_DEFAULT = 1;
 
+    // idle main loop: keep drawing briefly after input so ImGui can settle, then only refresh
+    // background work progress and open file dialogs
+    constexpr int IDLE_DELAY_MS = 500;
+    constexpr int IDLE_REFRESH_MS = 100;
+
     // bg color
     constexpr uint8_t BG_R = 20;
     constexpr uint8_t BG_G = 20;
@@ -74,6 +83,7 @@ namespace constants {
     const std::string DEFAULT_WINDOW_NAME = "Untitled";
 
     const std::string saveFileFilter = "(*.type){.type}";
+    const std::string mixdownFileFilter = "(*.wav){.wav}";
     const std::string songinfoFileFilter = "(*.json){.json}";
     const std::string imageFileFilters = "(*.jpg *.png){.jpg,.png}";
     const std::string musicFileFilters = "(*.flac *.mp3 *.ogg *.wav){.flac,.mp3,.ogg,.wav}";
@@ -81,6 +91,7 @@ namespace constants {
     constexpr int MENU_FONT_SIZE = 28;
 
     const std::string PREFERENCES_PATH = "preferences.json";
+    const std::string TRACE_PATH = "trace.json";
 
     const fs::path FONTS_DIR = fs::path("fonts");
     const fs::path MENU_FONT_PATH = FONTS_DIR / fs::path("NotoSans-Regular.ttf");
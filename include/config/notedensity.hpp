@@ -0,0 +1,36 @@
+#ifndef NOTEDENSITY_HPP
+#define NOTEDENSITY_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "config/notesequenceitem.hpp"
+
+// item counts per lane in fixed-width beat buckets, kept in step with every add and delete
+// so the minimap never has to walk the notes
+class NoteDensity {
+    public:
+        static constexpr double BUCKET_BEATS { 1.0 };
+        static constexpr size_t NUM_LANES { 5 };
+
+        void add(NoteSequenceItem::SequencerItemType lane, double absBeat);
+        void remove(NoteSequenceItem::SequencerItemType lane, double absBeat);
+
+        size_t getBucketCount() const;
+        int getCount(size_t lane, size_t bucket) const;
+
+        // the fullest bucket of any lane, recounted only after a delete emptied a fullest bucket
+        int getMaxCount();
+
+        size_t getMemoryUsage() const;
+    private:
+        static size_t getBucket(double absBeat);
+
+        std::vector<std::array<int, NUM_LANES>> buckets;
+
+        int maxCount { 0 };
+        bool maxCountStale { false };
+};
+
+#endif // NOTEDENSITY_HPP
@@ -0,0 +1,46 @@
+#ifndef NOTESELECTION_HPP
+#define NOTESELECTION_HPP
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "config/notesequenceitem.hpp"
+
+// an arbitrary set of items, held as handles sorted like the note store (by start beat),
+// so lookups are a binary search and the items come back out in chart order
+class NoteSelection {
+    public:
+        bool empty() const;
+        size_t size() const;
+        void clear();
+
+        bool contains(const std::shared_ptr<NoteSequenceItem> & item) const;
+
+        void add(const std::shared_ptr<NoteSequenceItem> & item);
+        void remove(const std::shared_ptr<NoteSequenceItem> & item);
+        void toggle(const std::shared_ptr<NoteSequenceItem> & item);
+
+        void add(const std::list<std::shared_ptr<NoteSequenceItem>> & items);
+        void remove(const std::list<std::shared_ptr<NoteSequenceItem>> & items);
+
+        // drops items deleted from the chart since they were selected
+        void removeDeleted();
+        // restores the order after selected items were moved to other beats
+        void sort();
+
+        std::list<std::shared_ptr<NoteSequenceItem>> getItems() const;
+
+        double getFirstBeat() const;
+        double getLastBeat() const;
+        int getMinItemType() const;
+        int getMaxItemType() const;
+
+        size_t getMemoryUsage() const;
+    private:
+        static bool compare(const std::shared_ptr<NoteSequenceItem> & lhs, const std::shared_ptr<NoteSequenceItem> & rhs);
+
+        std::vector<std::shared_ptr<NoteSequenceItem>> items;
+};
+
+#endif // NOTESELECTION_HPP
@@ -16,6 +16,8 @@
 #include "ImSequencer.h"
 
 #include "config/constants.hpp"
+#include "config/notedensity.hpp"
+#include "config/noteselection.hpp"
 #include "config/note.hpp"
 #include "config/skip.hpp"
 #include "config/stop.hpp"
@@ -26,6 +28,8 @@
 
 #include "systems/audiosystem.hpp"
 
+class Waveform;
+
 struct NoteSequence : public ImSequencer::SequenceInterface {
     NoteSequence() = default;
 
@@ -39,7 +43,33 @@ struct NoteSequence : public ImSequencer::SequenceInterface {
     std::map<std::string, int> keyFrequencies;
     std::vector<std::pair<std::string, int>> keyFreqsSorted;
 
+    // bumped whenever notes are added or removed
+    unsigned int revision { 0 };
+
+    // the longest item's length in beats, for culling items to the visible range
+    double maxItemBeats { 0.0 };
+    unsigned int maxItemBeatsRevision { 0 };
+    size_t maxItemBeatsCount { 0 };
+
+    NoteDensity density;
+
+    // the beat range the sequencer last drew, for the minimap's viewport
+    double viewFirstBeat { 0.0 };
+    double viewLastBeat { 0.0 };
+
+    // drawn behind the lanes; set by the timeline before each sequencer draw
+    const Waveform * waveform { nullptr };
+    const std::vector<Timeinfo> * waveformTimeinfo { nullptr };
+    int waveformOffsetMS { 0 };
+
+    // items in it are outlined by the sequencer; set by the timeline before each sequencer draw
+    const NoteSelection * selection { nullptr };
+
+    void setWaveform(const Waveform * waveform, const std::vector<Timeinfo> * timeinfo, int offsetMS);
+    void setSelection(const NoteSelection * selection);
+
     void update(double songBeat, AudioSystem * audioSystem, bool notesoundEnabled);
+    std::vector<double> getNoteTimes(const std::vector<Timeinfo> & timeinfo, int offsetMS) const;
     void resetPassed(double songBeat);
 
     void addNote(double absBeat, double songBeat, double beatDuration, BeatPos beatpos, BeatPos endBeatpos,
@@ -52,6 +82,7 @@ struct NoteSequence : public ImSequencer::SequenceInterface {
     void editSkip(double absBeat, double skipTime);
 
     void flipNotes(const std::string & keyboardLayout, double startBeat, double endBeat, int minItemType, int maxItemType);
+    void flipItems(const std::string & keyboardLayout, const std::list<std::shared_ptr<NoteSequenceItem>> & items);
 
     std::list<std::shared_ptr<NoteSequenceItem>> shiftNotes(const std::string &, double startBeat, double endBeat,
         int minItemType, int maxItemType, ShiftNoteAction::ShiftDirection shiftDirection);
@@ -60,14 +91,37 @@ struct NoteSequence : public ImSequencer::SequenceInterface {
     bool shiftNoteSequenceItem(ShiftNoteAction::ShiftDirection shiftDirection, std::shared_ptr<NoteSequenceItem> item, const std::string & keyboardLayout);
 
     std::list<std::shared_ptr<NoteSequenceItem>> getItems(double startBeat, double endBeat, int minItemType, int maxItemType) const;
-    std::shared_ptr<NoteSequenceItem> containsItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType);
+    std::list<std::shared_ptr<NoteSequenceItem>> getKeyItems(const std::string & key) const;
+    std::shared_ptr<NoteSequenceItem> containsItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType) const;
+    // the item starting exactly at absBeat in the lane, found by binary search
+    std::shared_ptr<NoteSequenceItem> getItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType) const;
+    // a live item equal to one that may have been deleted and re-created since
+    std::shared_ptr<NoteSequenceItem> findItem(const NoteSequenceItem & item) const;
+    // swaps deleted items for their live equals, dropping those without one
+    void reconcileItems(std::list<std::shared_ptr<NoteSequenceItem>> & items) const;
     int getLaneItemCount(NoteSequenceItem::SequencerItemType lane) const;
     void resetItemCounts();
 
+    // bytes held by the note store; a list is charged for the items only it keeps alive
+    size_t getMemoryUsage() const;
+    static size_t getItemMemoryUsage(const std::shared_ptr<NoteSequenceItem> & item);
+    static size_t getItemsMemoryUsage(const std::list<std::shared_ptr<NoteSequenceItem>> & items);
+
     void insertItems(double insertBeat, double songBeat, int minItemType, int maxItemType, const std::vector<Timeinfo> & timeinfo, std::list<std::shared_ptr<NoteSequenceItem>> items);
     void deleteItems(double startBeat, double endBeat, int minItemType, int maxItemType);
     void deleteItem(double absBeat, NoteSequenceItem::SequencerItemType itemType);
 
+    // removes and later puts back exactly these items, keeping their identity for the selection and undo history
+    void deleteItems(const std::list<std::shared_ptr<NoteSequenceItem>> & items);
+    void restoreItems(const std::list<std::shared_ptr<NoteSequenceItem>> & items, double songBeat);
+
+    // moves an item without reordering the store; call sortItems once all moves are done
+    void moveItem(const std::shared_ptr<NoteSequenceItem> & item, double absBeat, double beatEnd, BeatPos beatpos, BeatPos endBeatpos);
+    void sortItems();
+
+    void addItemCounts(const NoteSequenceItem & item);
+    void removeItemCounts(const NoteSequenceItem & item);
+
     const std::pair<std::string, int> & getKeyItemData(int frequencyRank) const;
     void updateKeyFrequencies();
 
@@ -79,7 +133,9 @@ struct NoteSequence : public ImSequencer::SequenceInterface {
     const char* GetItemLabel(int index) const override { return ""; }
 
     void Get(int index, double** start, double** end, int* type, unsigned int* color, const char** displayText) override;
+    void GetItems(double firstFrame, double lastFrame, std::vector<ImSequencer::SequenceItem> & items) override;
     size_t GetCustomHeight(int index) override { return 30; }
+    void DrawBackground(ImDrawList * draw_list, const ImRect & rc, double firstFrame, float framePixelWidth, bool darkTheme) override;
 };
 
 #endif // NOTESEQUENCE_HPP
@@ -27,13 +27,21 @@ struct SongPosition {
     bool addSection(int newBeatsPerMeasure, double newBPM, double newInterpolateDuration, BeatPos newBeatpos);
     bool editSection(int origSectionIndex, int newBeatsPerMeasure, double newBPM, double newInterpolateDuration, BeatPos newBeatpos);
     bool removeSection(int sectionIndex);
+    bool setSectionBPM(int sectionIndex, double newBPM);
 
     void pause();
     void unpause();
 
+    // the song clock, in performance counter ticks; runs at playbackRate times real time
+    Uint64 getClock() const;
+    void setPlaybackRate(double rate);
+
     void setSongTimePosition(double absTime);
     void setSongBeatPosition(double absBeat);
 
+    // once past loopEndTime, jump back by the loop length; returns whether it wrapped
+    bool wrapLoop(double loopStartTime, double loopEndTime);
+
     double calculateAbsBeat(BeatPos beatpos);
 
     bool started = false;
@@ -67,7 +75,14 @@ struct SongPosition {
     Uint64 songStart = 0;
     Uint64 pauseCounter = 0;
 
+    double playbackRate = 1.0;
+    Uint64 clockStart = 0;
+    Uint64 clockRealStart = 0;
+
     unsigned int currentSection = 0;
+
+    // bumped whenever the sections change, so cached beat -> time mappings can be refreshed
+    unsigned int timingRevision = 0;
     
     std::vector<Timeinfo> timeinfo;
     std::vector<std::shared_ptr<Skip>> skips;
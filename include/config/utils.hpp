@@ -2,7 +2,6 @@
 #define UTILS_HPP
 
 #include <memory>
-#include <stack>
 #include <string>
 #include <utility>
 #include <vector>
@@ -10,18 +9,19 @@
 #include "config/beatpos.hpp"
 #include "config/timeinfo.hpp"
 
-class EditAction;
-
 namespace utils {
 
-void emptyActionStack(std::stack<std::shared_ptr<EditAction>> & stack);
-
 void HelpMarker(const char* desc);
 bool showEditableText(const char * label, char * text, size_t bufSize, bool & editingText, std::string & savedText);
 
 BeatPos calculateBeatpos(double absBeat, int currentBeatsplit, const std::vector<Timeinfo> & timeinfo);
+double calculateAbsTime(double absBeat, const std::vector<Timeinfo> & timeinfo);
+double calculateAbsBeat(double absTime, const std::vector<Timeinfo> & timeinfo);
 std::pair<int, double> splitSecsbyMin(double seconds);
 
+// heap bytes of a string, beyond its small string buffer
+size_t getStringMemoryUsage(const std::string & str);
+
 bool cmpSecond(const std::pair<std::string, int> & l, const std::pair<std::string, int> & r);
 
 }
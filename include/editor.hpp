@@ -24,6 +24,8 @@ class Editor {
         bool isRunning() const;
     private:
         void handleEvents();
+        bool waitForEvent(SDL_Event & event);
+        bool isIdle() const;
         void update();
         void render();
 
@@ -45,6 +47,9 @@ class Editor {
 
         bool running { true };
 
+        // when the last event arrived, for the idle main loop
+        Uint32 lastEventTicks { 0 };
+
         // key states
         std::vector<bool> keysPressed;
         std::vector<bool> keysHeld;
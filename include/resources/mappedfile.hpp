@@ -0,0 +1,31 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// a whole file mapped read-only into memory; pages are loaded by the OS as they're touched
+class MappedFile {
+    public:
+        explicit MappedFile(const fs::path & path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        bool isOpen() const;
+        const unsigned char * getData() const;
+        std::size_t getSize() const;
+    private:
+        const unsigned char * data { nullptr };
+        std::size_t size { 0 };
+
+#ifdef _WIN32
+        void * fileHandle { nullptr };
+        void * mappingHandle { nullptr };
+#endif
+};
+
+#endif // MAPPEDFILE_HPP
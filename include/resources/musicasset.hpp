@@ -0,0 +1,88 @@
+#ifndef MUSICASSET_HPP
+#define MUSICASSET_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+#include "resources/mappedfile.hpp"
+
+namespace fs = std::filesystem;
+
+// one decoder for a music file, shared by every music source that plays it.
+// sources keep their own frame cursor; the decoder only seeks when a read doesn't continue the last one.
+// compressed files also get a seek index, built in the background, so reads anywhere are served without seeking.
+// uncompressed WAV files are mapped into memory and read from the mapping instead of through the decoder
+class MusicAsset {
+    public:
+        explicit MusicAsset(const fs::path & path);
+        ~MusicAsset();
+
+        MusicAsset(const MusicAsset &) = delete;
+        MusicAsset & operator=(const MusicAsset &) = delete;
+
+        bool isOpen() const;
+        const SF_INFO & getInfo() const;
+        const fs::path & getPath() const;
+
+        // read interleaved float frames starting at startFrame; returns the number of frames read
+        sf_count_t readFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames);
+
+        // float frames straight from the mapped file, or nullptr when the samples need converting;
+        // numFrames is reduced to what's available
+        const float * getMappedFrames(sf_count_t startFrame, sf_count_t & numFrames) const;
+
+        bool isMapped() const;
+        bool hasSeekIndex() const;
+        float getSeekIndexProgress() const;
+
+        // heap bytes of the decoded seek index; a mapping is backed by the file, so it isn't counted
+        size_t getMemoryUsage() const;
+    private:
+        static constexpr sf_count_t SEEK_INDEX_BLOCK_FRAMES { 1 << 15 };
+        static constexpr size_t MAX_SEEK_INDEX_BYTES { 256u << 20 };
+
+        static bool isCompressed(const SF_INFO & sfinfo);
+
+        bool mapPCM();
+        sf_count_t readMappedFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames) const;
+
+        void buildSeekIndex();
+        sf_count_t readIndexedFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames) const;
+
+        fs::path path;
+
+        SNDFILE * sndfile { nullptr };
+        SF_INFO sfinfo {};
+
+        sf_count_t decoderFrame { 0 };
+
+        // the PCM data chunk of a mapped WAV file
+        std::unique_ptr<MappedFile> mappedFile;
+        const unsigned char * pcmData { nullptr };
+        sf_count_t pcmFrames { 0 };
+        int pcmSubformat { 0 };
+
+        // decoded 16-bit blocks of the track, in order. blocks below indexedBlocks are complete
+        // and never change again, so the main thread reads them without locking
+        std::vector<std::vector<short>> seekIndex;
+        std::atomic<size_t> indexedBlocks { 0 };
+        std::atomic<bool> stopIndexing { false };
+        std::thread indexThread;
+};
+
+// music assets by canonical path and modification time; an asset lives as long as a source holds it
+class MusicAssetCache {
+    public:
+        std::shared_ptr<MusicAsset> acquire(const fs::path & path);
+    private:
+        std::map<std::string, std::weak_ptr<MusicAsset>> assets;
+};
+
+#endif // MUSICASSET_HPP
@@ -9,7 +9,15 @@
 namespace fs = std::filesystem;
 
 namespace Texture {
-    std::shared_ptr<SDL_Texture> loadTexture(const fs::path & path, SDL_Renderer * renderer);
+    // decodes an image, box filtered down so neither side exceeds maxSize. touches no renderer state,
+    // so it may run on a worker thread
+    SDL_Surface * loadSurface(const fs::path & path, int maxSize);
+
+    // uploads the surface and frees it, whether or not the texture could be created
+    std::shared_ptr<SDL_Texture> createTexture(SDL_Surface * surface, SDL_Renderer * renderer);
+
+    // estimated from the texture's size and pixel format
+    size_t getMemoryUsage(SDL_Texture * texture);
 };
 
 
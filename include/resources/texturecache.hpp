@@ -0,0 +1,66 @@
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+namespace fs = std::filesystem;
+
+// cover art decoded and downscaled on a worker thread, uploaded on the main thread,
+// and shared between every window showing the same file
+class TextureCache {
+    public:
+        struct Entry {
+            // null until uploaded, and stays null if the file couldn't be decoded
+            std::shared_ptr<SDL_Texture> texture;
+        };
+
+        explicit TextureCache(int maxSize);
+        ~TextureCache();
+
+        TextureCache(const TextureCache &) = delete;
+        TextureCache & operator=(const TextureCache &) = delete;
+
+        // main thread only
+        std::shared_ptr<Entry> load(const fs::path & path);
+        // creates textures for the images decoded since the last call
+        void upload(SDL_Renderer * renderer);
+
+        bool isLoading() const;
+    private:
+        struct Request {
+            fs::path path;
+            std::weak_ptr<Entry> entry;
+        };
+
+        struct Decoded {
+            std::weak_ptr<Entry> entry;
+            SDL_Surface * surface;
+        };
+
+        void decodeImages();
+
+        int maxSize;
+
+        // entries live as long as some window holds them
+        std::map<fs::path, std::weak_ptr<Entry>> entries;
+
+        mutable std::mutex mutex;
+        std::condition_variable requestReady;
+        std::deque<Request> requests;
+        std::vector<Decoded> decoded;
+        size_t pendingImages { 0 };
+        bool stopDecoding { false };
+
+        std::thread decodeThread;
+};
+
+#endif // TEXTURECACHE_HPP
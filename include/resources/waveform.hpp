@@ -0,0 +1,70 @@
+#ifndef WAVEFORM_HPP
+#define WAVEFORM_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+#include "imgui.h"
+#include "config/timeinfo.hpp"
+
+namespace fs = std::filesystem;
+
+struct ImRect;
+
+// min/max peak pyramid of a music file, built progressively on a worker thread.
+// level 0 holds one peak per BASE_BUCKET_FRAMES, each level above halves the resolution
+class Waveform {
+    public:
+        struct Peak {
+            float min;
+            float max;
+        };
+
+        explicit Waveform(const fs::path & musicPath);
+        ~Waveform();
+
+        Waveform(const Waveform &) = delete;
+        Waveform & operator=(const Waveform &) = delete;
+
+        bool build();
+        bool isFinished() const;
+
+        size_t getMemoryUsage() const;
+
+        void draw(ImDrawList * drawList, const ImRect & rc, double firstBeat, float pixelsPerBeat,
+            const std::vector<Timeinfo> & timeinfo, int offsetMS, ImU32 color) const;
+    private:
+        static constexpr sf_count_t BASE_BUCKET_FRAMES { 256 };
+        static constexpr sf_count_t DECODE_CHUNK_FRAMES { BASE_BUCKET_FRAMES * 64 };
+
+        void buildPeaks(SNDFILE * sndfile);
+        void buildLevels(bool complete);
+
+        bool loadCache();
+        void saveCache() const;
+
+        size_t getReadyBuckets(size_t level) const;
+        bool getPeak(sf_count_t startFrame, sf_count_t endFrame, Peak & peak) const;
+
+        fs::path musicPath;
+        fs::path cachePath;
+
+        int sampleRate { 0 };
+        int channels { 0 };
+        sf_count_t totalFrames { 0 };
+
+        std::vector<std::vector<Peak>> levels;
+        std::vector<size_t> levelsBuilt;
+
+        std::atomic<sf_count_t> framesReady { 0 };
+        std::atomic<bool> finished { false };
+        std::atomic<bool> stopBuilding { false };
+
+        std::thread buildThread;
+};
+
+#endif // WAVEFORM_HPP
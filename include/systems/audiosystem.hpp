@@ -2,10 +2,13 @@
 #define AUDIOSYSTEM_HPP
 
 #include <array>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <filesystem>
 
@@ -23,6 +26,10 @@
 
 #include <SDL2/SDL.h>
 
+#include "resources/musicasset.hpp"
+#include "systems/resampler.hpp"
+#include "systems/timestretcher.hpp"
+
 namespace fs = std::filesystem;
 
 /* Signature:
@@ -30,9 +37,24 @@ namespace fs = std::filesystem;
 */
 class AudioSystem {
     public:
-        void initAudioSystem(SDL_Window * window);
+        // Device plays through the default OpenAL device. Loopback renders nothing by itself, the
+        // caller pulls the mix with renderAudio(); Null pulls and discards it in real time from update()
+        enum class Backend {
+            Device,
+            Loopback,
+            Null
+        };
+
+        bool initAudioSystem(SDL_Window * window, Backend backend = Backend::Device);
         void quitAudioSystem();
 
+        // render the next numFrames of the mix as interleaved stereo float at LOOPBACK_FREQUENCY;
+        // samples may be null to discard them. Returns the frames rendered, 0 for the device backend
+        int renderAudio(float * samples, int numFrames);
+
+        static const int LOOPBACK_FREQUENCY = 48000;
+        static const int LOOPBACK_CHANNELS = 2;
+
         void update(SDL_Window * window);
 
         bool loadSound(std::string_view soundID, const fs::path & path);
@@ -40,14 +62,60 @@ class AudioSystem {
 
         void deactivateMusicSource(int sourceIdx);
 
+        // whether two music sources play the same file (and file version)
+        bool isSameMusic(int sourceIdx, int otherSourceIdx) const;
+
+        // resolve a sound once, then trigger it by handle (-1 if not loaded)
+        int getSoundHandle(std::string_view soundID) const;
+        void playSound(int soundHandle);
         void playSound(std::string_view soundID);
 
+        // mix a sound into the music stream at the given music times (seconds), instead of
+        // triggering it from the UI frame; an empty list clears the schedule
+        void setHitsounds(int sourceIdx, int soundHandle, const std::vector<double> & hitTimes);
+        void clearHitsounds(int sourceIdx);
+
+        // a tempo map section, in music time; beats are counted from measure 0
+        struct MetronomeSection {
+            double startTime;
+            double startMeasure;
+            double bpm;
+            int beatsPerMeasure;
+        };
+
+        // click on every beat of the sorted sections, accented on downbeats, mixed into the music stream;
+        // clicks are placed per buffer as it's filled, so edits are heard from the next buffer on
+        void setMetronome(int sourceIdx, std::vector<MetronomeSection> sections);
+        void clearMetronome(int sourceIdx);
+
+        // a loaded sound converted to the format of a music source, for mixing into it
+        std::vector<float> getHitsoundSamples(int sourceIdx, int soundHandle) const;
+        static std::vector<sf_count_t> getHitsoundFrames(int samplerate, const std::vector<double> & hitTimes);
+
+        // mix a sound into interleaved music frames [startFrame, startFrame + numFrames * rate) at each of the sorted hits
+        static void mixSound(float * buffer, int channels, double startFrame, sf_count_t numFrames, double rate,
+            const std::vector<sf_count_t> & hits, const std::vector<float> & samples, float gain);
+
         void startMusic(int sourceIdx, float startPosition = 0.f);
         void setMusicPosition(int sourceIdx, float position);
         void resumeMusic(int sourceIdx) const;
         void pauseMusic(int sourceIdx) const;
         void stopMusic(int sourceIdx);
 
+        // play a short grain of the music at position (seconds), to hear the playhead while it's dragged.
+        // grains are queued from update(); requests faster than they play only move the next grain
+        void scrubMusic(int sourceIdx, float position);
+        void stopScrub();
+
+        // loop [loopStart, loopEnd) seconds of the music gaplessly, from a copy decoded once.
+        // buffers not yet queued wrap at the loop end instead of running on
+        bool setMusicLoop(int sourceIdx, float loopStart, float loopEnd);
+        void clearMusicLoop(int sourceIdx);
+
+        // tempo of the music, pitch preserved; takes effect at the next start/setMusicPosition
+        void setPlaybackRate(int sourceIdx, double rate);
+        double getPlaybackRate(int sourceIdx) const;
+
         void setMusicVolume(float gain);
         void setSoundVolume(float gain);
 
@@ -58,31 +126,109 @@ class AudioSystem {
         bool isMusicPlaying(int sourceIdx) const;
         bool isMusicPaused(int sourceIdx) const;
 
+        // bytes of decode, conversion and mixing buffers held for a music source, including its share of the music asset
+        size_t getMemoryUsage(int sourceIdx) const;
+
+        // whether any music or scrub grains are playing, so streaming needs update() called every frame
+        bool isActive() const;
+
         bool getStopMusicEarly(int sourceIdx) const;
         void setStopMusicEarly(int sourceIdx, bool stopMusicEarly);
         
         float getMusicStop(int sourceIdx) const;
         void setMusicStop(int sourceIdx, float musicStop);
     private:
+        bool openLoopbackDevice();
+        void reportError(SDL_Window * window, const char * title, const char * message) const;
+
         void initSoundSource(ALuint source, float pitch, float gain, std::array<float, 3> position, std::array<float, 3> velocity, bool looping) const;
 
         float getBufferLength(ALuint bufid) const;
 
         void updateBufferStream(SDL_Window * window, int sourceIdx);
 
+        // frames points at stereo samples at the device rate, ready to buffer
+        sf_count_t readOutputFrames(int sourceIdx, const float *& frames);
+        const float * remixMusicFrames(int sourceIdx, const float * frames, sf_count_t numFrames);
+        void bufferMusicFrames(ALuint buffer, const float * frames, sf_count_t numFrames, int samplerate);
+
+        // frames points at the music's own samples: membufs, or the mapped music file when nothing needs mixing
+        sf_count_t readMusicFrames(int sourceIdx, const float *& frames);
+        sf_count_t readDecodedFrames(int sourceIdx);
+        const float * readMappedFrames(int sourceIdx, sf_count_t & numFrames);
+        void mixHitsounds(int sourceIdx, double startFrame, sf_count_t numFrames);
+        void mixMetronome(int sourceIdx, double startFrame, sf_count_t numFrames);
+
+        void updateScrub();
+        bool queueScrubGrain();
+
         static const int BUFFER_FRAMES = 8192;
         static const int NUM_BUFFERS = 4;
 
+        static const int RENDER_CHUNK_FRAMES = 4096;
+
+        // music is buffered as stereo at the device rate, whatever the file's layout and rate
+        static const int OUTPUT_CHANNELS = 2;
+
         static const int NUM_SOUND_SOURCES = 128;
-        static const int NUM_MUSIC_SOURCES = 16;
+        static const int NUM_MUSIC_SOURCES = 64;
+
+        // limits how much a mixed hitsound is boosted to make up for a quiet music gain
+        static constexpr float MAX_HITSOUND_MIX_GAIN = 4.f;
 
-        ALCdevice * soundDevice;
-        ALCcontext * soundContext;
+        static constexpr double METRONOME_CLICK_SECONDS = 0.03;
+
+        // grains are short enough to follow the playhead, with fades so they don't click;
+        // at most two are queued, so scrubbing lags the playhead by two grains at worst
+        static constexpr float SCRUB_GRAIN_SECONDS = 0.06f;
+        static constexpr float SCRUB_FADE_SECONDS = 0.006f;
+        static const int NUM_SCRUB_BUFFERS = 3;
+        static const int MAX_SCRUB_GRAINS_QUEUED = 2;
+
+        static constexpr double MIN_PLAYBACK_RATE = 0.25;
+        static constexpr double MAX_PLAYBACK_RATE = 1.5;
+
+        struct MusicLoop {
+            bool active { false };
+            sf_count_t startFrame { 0 };
+            sf_count_t endFrame { 0 };
+
+            std::vector<float> samples;
+
+            // wraps already decoded, that the stream position and the playing buffer haven't reached yet
+            int streamWrapsPending { 0 };
+            int bufferWrapsPending { 0 };
+        };
+
+        struct LoadedSound {
+            ALuint buffer;
+
+            // decoded copy, for mixing into the music stream
+            std::vector<float> samples;
+            int channels;
+            int samplerate;
+        };
+
+        Backend backend { Backend::Device };
+
+        ALCdevice * soundDevice { nullptr };
+        ALCcontext * soundContext { nullptr };
+
+#ifndef __APPLE__
+        LPALCRENDERSAMPLESSOFT renderSamples { nullptr };
+#endif
+        std::vector<float> renderScratch;
+        Uint64 lastRenderCounter { 0 };
+
+        int deviceFrequency { LOOPBACK_FREQUENCY };
 
         std::array<ALuint, NUM_SOUND_SOURCES> soundBuffers;
         std::array<ALuint, NUM_SOUND_SOURCES> soundSources;
 
-        std::array<std::array<ALuint, NUM_MUSIC_SOURCES>, NUM_BUFFERS> musicBuffers;
+        // voices are handed out round robin, so the next voice is always the oldest one
+        int nextSoundSource { 0 };
+
+        std::array<std::array<ALuint, NUM_BUFFERS>, NUM_MUSIC_SOURCES> musicBuffers;
         std::array<ALuint, NUM_MUSIC_SOURCES> musicSources;
 
         // for tracking time position of music
@@ -90,17 +236,62 @@ class AudioSystem {
         std::array<float, NUM_MUSIC_SOURCES> musicStops;
         std::array<bool, NUM_MUSIC_SOURCES> stopMusicsEarly;
 
-        std::array<SNDFILE *, NUM_MUSIC_SOURCES> sndfiles;
+        // a music source is a cursor into a shared asset, plus its own AL source and buffers
+        MusicAssetCache musicAssetCache;
+        std::array<std::shared_ptr<MusicAsset>, NUM_MUSIC_SOURCES> musicAssets;
         std::array<SF_INFO, NUM_MUSIC_SOURCES> sfInfos;
         std::array<float *, NUM_MUSIC_SOURCES> membufs;
 
-        std::unordered_map<std::string_view, ALuint> soundBufferIDs;
+        // next frame to decode; runs ahead of the stream position while time-stretching
+        std::array<sf_count_t, NUM_MUSIC_SOURCES> decodeFramePositions;
+
+        // music frame at which the next buffer starts; buffers cover numFrames * rate music frames
+        std::array<double, NUM_MUSIC_SOURCES> streamFramePositions;
+
+        std::array<double, NUM_MUSIC_SOURCES> playbackRates;
+        std::array<TimeStretcher, NUM_MUSIC_SOURCES> timeStretchers;
+
+        std::array<MusicLoop, NUM_MUSIC_SOURCES> musicLoops;
+
+        // one scrub voice, for whichever music source is being scrubbed
+        ALuint scrubSource { 0 };
+        std::array<ALuint, NUM_SCRUB_BUFFERS> scrubBuffers;
+        std::vector<ALuint> freeScrubBuffers;
+        std::vector<float> scrubSamples;
+        std::vector<float> scrubGrain;
+        int scrubSourceIdx { -1 };
+        float scrubPosition { 0.f };
+        bool scrubPending { false };
+
+        // conversion to the output format: left then right weights per file channel for downmixing,
+        // a resampler for files not at the device rate, and the converted frames
+        std::array<std::vector<float>, NUM_MUSIC_SOURCES> downmixWeights;
+        std::array<Resampler, NUM_MUSIC_SOURCES> resamplers;
+        std::array<std::vector<float>, NUM_MUSIC_SOURCES> outputbufs;
+
+        // sorted start frames of the scheduled hitsounds, and the sound converted to the music's format
+        std::array<std::vector<sf_count_t>, NUM_MUSIC_SOURCES> hitsoundFrames;
+        std::array<std::vector<float>, NUM_MUSIC_SOURCES> hitsoundSamples;
+
+        // the metronome's tempo map and clicks in the music's format, and the clicks placed in the current buffer
+        std::array<std::vector<MetronomeSection>, NUM_MUSIC_SOURCES> metronomeSections;
+        std::array<std::vector<float>, NUM_MUSIC_SOURCES> beatClickSamples;
+        std::array<std::vector<float>, NUM_MUSIC_SOURCES> downbeatClickSamples;
+        std::vector<sf_count_t> beatClickFrames;
+        std::vector<sf_count_t> downbeatClickFrames;
+
+        float musicGain { 1.f };
+        float soundGain { 1.f };
+
+        std::vector<LoadedSound> loadedSounds;
+        std::unordered_map<std::string, int> soundHandles;
 
         std::map<int, bool> musicSourcesActive;
 
         // Force to read float samples to avoid clipping issue
 #ifdef __APPLE__
         ALenum musicFormat = AL_FORMAT_STEREO16;
+        std::vector<std::int16_t> deviceSamples;
 #else
         ALenum musicFormat = AL_FORMAT_STEREO_FLOAT32;
 #endif
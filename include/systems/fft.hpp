@@ -0,0 +1,41 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <cstddef>
+#include <vector>
+
+// real FFT computed as a half size radix-2 complex FFT, with split real/imaginary
+// buffers so the butterflies vectorize
+class FFT {
+    public:
+        explicit FFT(std::size_t size);
+
+        // hann-windowed magnitude spectrum of `size` real samples, written to size / 2 + 1 bins
+        void magnitudes(const float * input, float * magnitudesOut);
+
+        std::size_t getSize() const;
+        std::size_t getNumBins() const;
+    private:
+        void transform();
+        void butterflies(std::size_t half, const float * twiddleRe, const float * twiddleIm);
+
+        std::size_t size { 0 };
+
+        std::vector<std::size_t> bitReversed;
+        std::vector<float> window;
+
+        std::size_t complexSize { 0 };
+
+        // twiddles for each stage stored back to back, stage with half length h starts at h - 1
+        std::vector<float> twiddleRe;
+        std::vector<float> twiddleIm;
+
+        // twiddles used to split the packed complex spectrum back into the real one
+        std::vector<float> splitRe;
+        std::vector<float> splitIm;
+
+        std::vector<float> re;
+        std::vector<float> im;
+};
+
+#endif // FFT_HPP
@@ -0,0 +1,73 @@
+#ifndef MIXDOWNEXPORTER_HPP
+#define MIXDOWNEXPORTER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+namespace fs = std::filesystem;
+
+// renders a music file with a sound mixed in at every hit into a 16-bit WAV file.
+// blocks of the song are decoded and mixed on several threads, then written in order
+class MixdownExporter {
+    public:
+        MixdownExporter() = default;
+        ~MixdownExporter();
+
+        MixdownExporter(const MixdownExporter &) = delete;
+        MixdownExporter & operator=(const MixdownExporter &) = delete;
+
+        // soundSamples must already be in the music's channel layout and sample rate
+        bool start(const fs::path & musicPath, const fs::path & outputPath, std::vector<float> soundSamples, const std::vector<double> & hitTimes);
+        void stop();
+
+        bool isRunning() const;
+        bool isFinished() const;
+        bool hasFailed() const;
+        float getProgress() const;
+    private:
+        static constexpr sf_count_t BLOCK_FRAMES { 1 << 16 };
+        static const int BLOCKS_IN_FLIGHT_PER_WORKER = 2;
+        static const int MAX_WORKERS = 8;
+
+        void exportMixdown(SNDFILE * outputFile);
+        void mixBlocks();
+
+        // sets a flag the writer and workers wait on, under their lock so no waiter misses it
+        void signal(std::atomic<bool> & flag);
+
+        fs::path musicPath;
+        fs::path outputPath;
+        SF_INFO musicInfo {};
+
+        std::vector<float> soundSamples;
+        std::vector<sf_count_t> hitFrames;
+
+        sf_count_t numBlocks { 0 };
+        sf_count_t maxBlocksInFlight { 0 };
+
+        // mixed blocks waiting to be written, by block index
+        std::map<sf_count_t, std::vector<float>> mixedBlocks;
+        sf_count_t nextWriteBlock { 0 };
+
+        std::mutex blockMutex;
+        std::condition_variable blockMixed;
+        std::condition_variable blockWritten;
+
+        std::atomic<sf_count_t> nextMixBlock { 0 };
+
+        std::atomic<float> progress { 0.f };
+        std::atomic<bool> finished { false };
+        std::atomic<bool> failed { false };
+        std::atomic<bool> stopExport { false };
+
+        std::thread exportThread;
+};
+
+#endif // MIXDOWNEXPORTER_HPP
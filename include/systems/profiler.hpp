@@ -0,0 +1,103 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include <SDL2/SDL.h>
+
+#include "systems/tracer.hpp"
+
+// scoped timers compile to nothing unless the build enables the profiler
+#ifdef TYPECHART_PROFILER
+    #define PROFILER_CONCAT_IMPL(a, b) a##b
+    #define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+    #define PROFILE_SCOPE(zone) Profiler::ScopedTimer PROFILER_CONCAT(profileScope, __LINE__) { Profiler::Zone::zone }
+    #define PROFILE_BEGIN_FRAME() Profiler::Instance().beginFrame()
+    #define PROFILE_END_FRAME() Profiler::Instance().endFrame()
+    #define PROFILE_SHOW_OVERLAY() Profiler::Instance().showOverlay()
+#else
+    #define PROFILE_SCOPE(zone)
+    #define PROFILE_BEGIN_FRAME()
+    #define PROFILE_END_FRAME()
+    #define PROFILE_SHOW_OVERLAY()
+#endif
+
+class Profiler {
+    public:
+        enum class Zone {
+            AUDIO_UPDATE,
+            SEQUENCER,
+            NOTES_UPDATE,
+            CHART_DATA,
+            CHART_LOAD,
+            CHART_SAVE,
+            RENDER,
+            COUNT
+        };
+
+        class ScopedTimer {
+            public:
+                explicit ScopedTimer(Zone zone);
+                ~ScopedTimer();
+
+                ScopedTimer(const ScopedTimer &) = delete;
+                ScopedTimer & operator=(const ScopedTimer &) = delete;
+            private:
+                Zone zone;
+                Uint64 start;
+        };
+
+        static Profiler & Instance() {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        Profiler(const Profiler &) = delete;
+        Profiler & operator=(const Profiler &) = delete;
+
+        static const char * getZoneName(Zone zone);
+
+        // may be called from any thread
+        void record(Zone zone, Uint64 start, Uint64 end);
+
+        // frames are timed from after the main loop stops waiting for events
+        void beginFrame();
+        // collects the samples recorded since the last call into the frame history
+        void endFrame();
+
+        void setShowOverlay(bool showOverlay);
+        bool isOverlayShown() const;
+        void showOverlay();
+    private:
+        Profiler() {}
+
+        struct Sample {
+            Zone zone;
+            Uint64 duration;
+        };
+
+        struct FrameTimes {
+            double frameMS { 0.0 };
+            std::array<double, static_cast<size_t>(Zone::COUNT)> zoneMS {};
+        };
+
+        static constexpr size_t RING_SIZE { 4096 };
+        static constexpr size_t HISTORY_FRAMES { 240 };
+
+        // multi-producer ring read only by endFrame(); each slot is published by its own sequence number
+        std::array<Sample, RING_SIZE> samples {};
+        std::array<std::atomic<size_t>, RING_SIZE> sampleSequences {};
+        std::atomic<size_t> writeIndex { 0 };
+        size_t readIndex { 0 };
+
+        std::array<FrameTimes, HISTORY_FRAMES> history {};
+        size_t historyFrames { 0 };
+        size_t historyIndex { 0 };
+
+        Uint64 frameStart { 0 };
+        bool overlayShown { false };
+};
+
+#endif // PROFILER_HPP
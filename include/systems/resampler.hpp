@@ -0,0 +1,59 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// polyphase windowed-sinc resampler for interleaved float audio.
+// Output frame j lines up with input frame j * inRate / outRate, with no added latency.
+class Resampler {
+    public:
+        void reset(int channels, int inRate, int outRate);
+
+        // feed input as it is decoded, then call finish() once the input has ended;
+        // after that, whatever is left of the output is ready to be pulled
+        void pushInput(const float * samples, std::size_t numFrames);
+        void finish();
+        bool isFinished() const;
+
+        std::size_t getOutputFrames() const;
+        std::size_t pullOutput(float * samples, std::size_t maxFrames);
+
+        std::size_t getMemoryUsage() const;
+    private:
+        void appendInput(const float * samples, std::size_t numFrames);
+        void process();
+
+        static const int TAPS = 64;
+        static const int HALF_TAPS = TAPS / 2;
+        static const int PHASES = 128;
+
+        static constexpr double KAISER_BETA = 8.0;
+
+        // passband edge as a fraction of the lower of the two Nyquist rates
+        static constexpr double CUTOFF = 0.92;
+
+        int channels { 0 };
+        double step { 1.0 };
+
+        // TAPS coefficients for each of PHASES + 1 fractional offsets, and the difference to the next
+        // phase, for interpolating between them
+        std::vector<float> kernels;
+        std::vector<float> kernelDeltas;
+        std::vector<float> kernel;
+
+        // planar input per channel; history[c][0] is input frame historyStart
+        std::vector<std::vector<float>> history;
+        std::int64_t historyStart { 0 };
+        std::int64_t inputFrames { 0 };
+
+        // input position of the next output frame
+        double time { 0.0 };
+
+        std::vector<float> output;
+
+        bool finished { false };
+};
+
+#endif // RESAMPLER_HPP
@@ -0,0 +1,44 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TYPECHART_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define TYPECHART_SIMD_NEON
+#endif
+
+// vectorized sample kernels, with scalar fallbacks on other targets
+namespace simd {
+    void minMax(const float * samples, std::size_t count, float & minOut, float & maxOut);
+
+    // values[i] = ln(1 + scale * values[i]), approximated (~1e-5 abs error) for non-negative input
+    void logCompress(float * values, std::size_t count, float scale);
+
+    float dotProduct(const float * a, const float * b, std::size_t count);
+
+    // sum of max(curr[i] - prev[i], 0), i.e. half-wave rectified spectral flux
+    float positiveDifferenceSum(const float * curr, const float * prev, std::size_t count);
+
+    // dst[i] += gain * src[i]
+    void mixAdd(float * dst, const float * src, std::size_t count, float gain);
+
+    // dst[i] += a[i] * b[i]
+    void multiplyAdd(float * dst, const float * a, const float * b, std::size_t count);
+
+    // integer PCM to float in [-1, 1), scaled the same way libsndfile does
+    void int16ToFloat(float * dst, const std::int16_t * src, std::size_t count);
+    void int32ToFloat(float * dst, const std::int32_t * src, std::size_t count);
+
+    // float in [-1, 1] to 16-bit PCM, clamped
+    void floatToInt16(std::int16_t * dst, const float * src, std::size_t count);
+
+    // interleaved stereo from mono, and from `channels` interleaved channels with per channel weights
+    void monoToStereo(float * dst, const float * src, std::size_t numFrames);
+    void downmixToStereo(float * dst, const float * src, std::size_t numFrames, int channels,
+        const float * leftWeights, const float * rightWeights);
+}
+
+#endif // SIMD_HPP
@@ -0,0 +1,84 @@
+#ifndef TEMPOANALYZER_HPP
+#define TEMPOANALYZER_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <sndfile.h>
+
+namespace fs = std::filesystem;
+
+// offline onset detection (spectral flux) over a music file, run on a worker thread,
+// used to suggest the initial bpm, first beat offset and any tempo changes
+class TempoAnalyzer {
+    public:
+        struct TempoChange {
+            double time;
+            double bpm;
+        };
+
+        struct TempoEstimate {
+            double bpm { 0.0 };
+            int offsetMS { 0 };
+            double confidence { 0.0 };
+
+            std::vector<TempoChange> tempoChanges;
+        };
+
+        TempoAnalyzer() = default;
+        ~TempoAnalyzer();
+
+        TempoAnalyzer(const TempoAnalyzer &) = delete;
+        TempoAnalyzer & operator=(const TempoAnalyzer &) = delete;
+
+        bool start(const fs::path & musicPath);
+        void stop();
+
+        bool isRunning() const;
+        bool isFinished() const;
+        bool hasFailed() const;
+        float getProgress() const;
+
+        // only valid once isFinished() returns true
+        const TempoEstimate & getEstimate() const;
+    private:
+        struct BeatGrid {
+            double period { 0.0 };
+            double phase { 0.0 };
+            double strength { 0.0 };
+        };
+
+        struct TempoSegment {
+            size_t first;
+            size_t last;
+            double bpm;
+        };
+
+        void analyze(SNDFILE * sndfile, SF_INFO sfinfo);
+        bool computeOnsetEnvelope(SNDFILE * sndfile, const SF_INFO & sfinfo);
+
+        BeatGrid estimateBeatGrid(size_t first, size_t last, double minPeriod, double maxPeriod) const;
+        double findAutocorrelationPeriod(size_t first, size_t last, double minPeriod, double maxPeriod) const;
+        BeatGrid scorePeriod(size_t first, size_t last, double period) const;
+
+        std::vector<TempoSegment> findTempoSegments() const;
+
+        double frameToTime(double frame) const;
+        double periodToBpm(double period) const;
+
+        double analysisRate { 0.0 };
+        std::vector<float> onsetEnvelope;
+
+        TempoEstimate estimate;
+
+        std::atomic<float> progress { 0.f };
+        std::atomic<bool> finished { false };
+        std::atomic<bool> failed { false };
+        std::atomic<bool> stopAnalysis { false };
+
+        std::thread analysisThread;
+};
+
+#endif // TEMPOANALYZER_HPP
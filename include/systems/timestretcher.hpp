@@ -0,0 +1,64 @@
+#ifndef TIMESTRETCHER_HPP
+#define TIMESTRETCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// WSOLA time-stretcher: changes the tempo of interleaved float audio while keeping its pitch.
+// Output frame j lines up with input frame j * rate, so the stretched audio stays on the song clock.
+class TimeStretcher {
+    public:
+        void reset(int channels, int samplerate, double rate);
+
+        // feed input as it is decoded, then call finish() once the input has ended;
+        // after that, whatever is left of the output is ready to be pulled
+        void pushInput(const float * samples, std::size_t numFrames);
+        void finish();
+        bool isFinished() const;
+
+        std::size_t getOutputFrames() const;
+        std::size_t pullOutput(float * samples, std::size_t maxFrames);
+
+        std::size_t getMemoryUsage() const;
+    private:
+        bool processSegment();
+        std::int64_t getNominalStart(std::int64_t segment) const;
+        std::int64_t findBestSegment(std::int64_t nominalStart) const;
+        float scoreSegment(std::int64_t start, const float * target) const;
+
+        void appendInput(const float * samples, std::size_t numFrames);
+        void trimInput();
+
+        static constexpr double WINDOW_SECONDS = 0.04;
+        static constexpr double SEEK_SECONDS = 0.01;
+        static const int COARSE_SEEK_STEP = 4;
+
+        int channels { 0 };
+        double rate { 1.0 };
+
+        std::size_t windowFrames { 0 };
+        std::size_t hopFrames { 0 };
+        std::int64_t seekFrames { 0 };
+
+        // periodic Hann, interleaved to match the input; two windows half a window apart sum to one
+        std::vector<float> window;
+
+        // input[0] is input frame inputStart; mono is the channel sum, used to match segments
+        std::vector<float> input;
+        std::vector<float> mono;
+        std::int64_t inputStart { 0 };
+        std::int64_t inputEnd { 0 };
+
+        // overlap-add accumulator of one window, and the finished frames ready to be pulled
+        std::vector<float> overlap;
+        std::vector<float> output;
+
+        std::int64_t numSegments { 0 };
+        std::int64_t prevSegmentStart { 0 };
+
+        bool finished { false };
+        bool drained { false };
+};
+
+#endif // TIMESTRETCHER_HPP
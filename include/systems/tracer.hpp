@@ -0,0 +1,101 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+namespace fs = std::filesystem;
+
+// trace events compile to nothing unless the build enables the profiler
+#ifdef TYPECHART_PROFILER
+    #define TRACER_CONCAT_IMPL(a, b) a##b
+    #define TRACER_CONCAT(a, b) TRACER_CONCAT_IMPL(a, b)
+    #define TRACE_SCOPE(name) Tracer::ScopedEvent TRACER_CONCAT(traceScope, __LINE__) { name }
+    #define TRACE_THREAD_NAME(name) Tracer::Instance().setThreadName(name)
+    #define TRACE_COUNTER(name, id, value) Tracer::Instance().counter(name, id, value)
+#else
+    #define TRACE_SCOPE(name)
+    #define TRACE_THREAD_NAME(name)
+    #define TRACE_COUNTER(name, id, value)
+#endif
+
+// records begin/end events per thread, to be saved in the chrome://tracing (and Perfetto) JSON format
+class Tracer {
+    public:
+        class ScopedEvent {
+            public:
+                // the name must outlive the trace, e.g. a string literal
+                explicit ScopedEvent(const char * name);
+                ~ScopedEvent();
+
+                ScopedEvent(const ScopedEvent &) = delete;
+                ScopedEvent & operator=(const ScopedEvent &) = delete;
+            private:
+                const char * name;
+        };
+
+        static Tracer & Instance() {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        Tracer(const Tracer &) = delete;
+        Tracer & operator=(const Tracer &) = delete;
+
+        void begin(const char * name);
+        void end(const char * name);
+        // a sample of the counter track for name and id
+        void counter(const char * name, int id, double value);
+        void setThreadName(const std::string & name);
+
+        void setRecording(bool recording);
+        bool isRecording() const;
+
+        bool save(const fs::path & tracePath);
+    private:
+        Tracer() {}
+
+        struct Event {
+            const char * name;
+            Uint64 ticks;
+            unsigned int tid;
+            char phase;
+
+            // counter events only
+            int id;
+            double value;
+        };
+
+        // each thread writes only its own buffer; the lock is contended only while saving
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::vector<Event> events;
+            size_t next { 0 };
+            unsigned int tid { 0 };
+            std::atomic<bool> inUse { false };
+        };
+
+        struct ThreadHandle;
+
+        // the most recent events kept per thread
+        static constexpr size_t EVENTS_PER_THREAD { 1 << 16 };
+
+        ThreadBuffer & getThreadBuffer();
+        void record(const char * name, char phase, int id = 0, double value = 0.0);
+
+        std::atomic<bool> recording { false };
+        std::atomic<unsigned int> nextTid { 1 };
+
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::map<unsigned int, std::string> threadNames;
+};
+
+#endif // TRACER_HPP
@@ -11,7 +11,10 @@
 #include "config/chartinfo.hpp"
 #include "config/songinfo.hpp"
 #include "config/songposition.hpp"
-#include "resources/texture.hpp"
+#include "resources/texturecache.hpp"
+#include "resources/waveform.hpp"
+#include "systems/mixdownexporter.hpp"
+#include "systems/tempoanalyzer.hpp"
 #include "ui/timeline.hpp"
 
 namespace fs = std::filesystem;
@@ -19,7 +22,19 @@ namespace fs = std::filesystem;
 class AudioSystem;
 
 struct EditWindow {
-    EditWindow(bool open, int ID, int musicSourceIdx, std::string_view name, std::shared_ptr<SDL_Texture> artTexture,
+    // bytes held for the window, by what holds them
+    struct MemoryUsage {
+        size_t notes { 0 };
+        size_t undoHistory { 0 };
+        size_t clipboard { 0 };
+        size_t audio { 0 };
+        size_t waveform { 0 };
+        size_t textures { 0 };
+
+        size_t getTotal() const;
+    };
+
+    EditWindow(bool open, int ID, int musicSourceIdx, std::string_view name, std::shared_ptr<TextureCache::Entry> artTexture,
         const ChartInfo & chartinfo, const SongInfo & songinfo);
 
     bool open { true };
@@ -29,15 +44,42 @@ struct EditWindow {
     bool resetInfoDisplay { false };
 
     bool editingSomething { false };
+    bool showTempoDetection { false };
+    bool showMixdownExport { false };
+    bool loopEnabled { false };
+
+    // what the notesounds mixed into the music were last scheduled from
+    bool hitsoundsScheduled { false };
+    unsigned int hitsoundsNotesRevision { 0 };
+    unsigned int hitsoundsTimingRevision { 0 };
+    int hitsoundsOffsetMS { 0 };
+
+    // what the metronome was last scheduled from
+    bool metronomeScheduled { false };
+    unsigned int metronomeTimingRevision { 0 };
+    int metronomeOffsetMS { 0 };
+
+    // section list labels, rebuilt only when the sections change
+    std::vector<std::string> sectionLabels;
+    unsigned int sectionLabelsTimingRevision { 0 };
+
+    // the looped beats, and the music times last given to the audio system for them
+    double loopStartBeat { 0.0 };
+    double loopEndBeat { 0.0 };
+    float loopStartTime { 0.f };
+    float loopEndTime { 0.f };
 
     int ID { 0 };
     int musicSourceIdx { 0 };
-    int lastSavedActionIndex { 0 };
+    size_t lastSavedActionIndex { 0 };
     int currTopNotes { 0 };
 
     std::string name;
 
-    std::shared_ptr<SDL_Texture> artTexture;
+    std::shared_ptr<TextureCache::Entry> artTexture;
+    std::shared_ptr<Waveform> waveform;
+    std::shared_ptr<TempoAnalyzer> tempoAnalyzer;
+    std::shared_ptr<MixdownExporter> mixdownExporter;
 
     ChartInfo chartinfo;
     SongInfo songinfo;
@@ -48,10 +90,18 @@ struct EditWindow {
     void saveCurrentChartFiles();
     void saveCurrentChartFiles(std::string_view chartSaveFilename, const fs::path & chartSavePath, const fs::path & saveDir);
 
+    void exportMixdown(AudioSystem * audioSystem, const fs::path & outputPath);
+    void showMixdownExportWindow();
+
     void undoLastAction();
     void redoLastAction();
+    void refreshSelection();
 
     void showContents(AudioSystem * audioSystem, std::vector<bool> & keysPressed);
+    void updateHitsounds(AudioSystem * audioSystem);
+    void updateMetronome(AudioSystem * audioSystem);
+
+    MemoryUsage getMemoryUsage(const AudioSystem * audioSystem) const;
 
     void showMetadata();
     bool showSongConfig();
@@ -65,12 +115,23 @@ struct EditWindow {
     void showRemoveSection();
     void showSectionDataWindow(bool & newSection, bool newSectionEdit, bool initSectionData);
     void showChartSectionList(AudioSystem * audioSystem);
+    void updateSectionLabels();
+    void showDetectTempo();
+    void showTempoDetectionWindow();
+    void applyDetectedTempo(const TempoAnalyzer::TempoEstimate & estimate);
+    void applyDetectedTempoChanges(const TempoAnalyzer::TempoEstimate & estimate);
 
     void showChartStatistics();
 
     void showToolbar(AudioSystem * audioSystem, std::vector<bool> & keysPressed);
     void showMusicPosition(float musicLengthSecs) const;
     void showMusicControls(AudioSystem * audioSystem, std::vector<bool> & keysPressed);
+    void showPlaybackRate(AudioSystem * audioSystem);
+    void showLoopToggle(AudioSystem * audioSystem);
+    void setLoopEnabled(AudioSystem * audioSystem, bool enabled);
+    // requeue = false leaves refilling the music after a loop change to the caller
+    void updateLoop(AudioSystem * audioSystem, bool requeue = true);
+    void setPlaybackRate(AudioSystem * audioSystem, double rate);
     void showMusicPreview(AudioSystem * audioSystem, float musicLengthSecs);
     void showMusicPreviewSliders(float musicLengthSecs);
     void showMusicPreviewButton(AudioSystem * audioSystem);
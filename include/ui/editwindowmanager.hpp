@@ -4,8 +4,13 @@
 #include <filesystem>
 #include <queue>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "resources/texturecache.hpp"
+#include "systems/tempoanalyzer.hpp"
 #include "ui/editwindow.hpp"
+#include "ui/windowsizes.hpp"
 
 namespace fs = std::filesystem;
 
@@ -26,14 +31,25 @@ public:
 
     void startNewEditWindow();
     void startSaveCurrentChart(bool saveAs = false);
+    void startExportMixdown() const;
 
     void showInitEditWindow(AudioSystem * audioSystem, SDL_Renderer * renderer);
     
     void showEditWindows(AudioSystem * audioSystem, std::vector<bool> & keysPressed);
     bool checkWindowFocus(unsigned int i, EditWindow & currWindow);
     void showSaveChart(bool & updatedName, ImVec2 & sizeBeforeUpdate, ImVec2 & currWindowSize);
+    void showExportMixdown(AudioSystem * audioSystem);
     void checkUndoRedo();
 
+    bool isBusy() const;
+    // a song position runs on its own even where no music is playing, e.g. past the music's end
+    bool isPlaying() const;
+
+    void uploadCoverArt(SDL_Renderer * renderer);
+
+    void setShowMemoryUsage(bool showMemoryUsage);
+    void showMemoryUsage(const AudioSystem * audioSystem);
+
     void createNewEditWindow(AudioSystem * audioSystem, SDL_Renderer * renderer);
 
     void closeWindow(const EditWindow & currWindow, std::vector<EditWindow>::iterator & iter, AudioSystem * audioSystem);
@@ -43,12 +59,16 @@ public:
     void setPaste(bool paste);
     void setCut(bool cut);
     void setFlip(bool flip);
+    void setSelectAll(bool selectAll);
+    void setQuantize(bool quantize);
     void setUndo(bool undo);
     void setRedo(bool redo);
 private:
     std::pair<std::string, int> getNextWindowNameAndID();
+    std::shared_ptr<Waveform> getWaveform(AudioSystem * audioSystem, int musicSourceIdx, const fs::path & musicPath) const;
 
     void showSongConfig();
+    void showDetectBPM();
     void showChartConfig();
 
     unsigned int currentWindow { 0 };
@@ -57,6 +77,8 @@ private:
     bool activateUndo { false };
     bool activateRedo { false };
     bool popupFailedToLoadMusic { false };
+    bool bpmDetectionApplied { false };
+    bool memoryUsageShown { false };
 
     int UIlevel { 1 };
     int UIkeyboardLayout { 0 };
@@ -74,9 +96,19 @@ private:
     std::string UImusicFilepath = "";
     std::string UIcoverArtFilepath = "";
 
+    std::string bpmDetectionMusicFilepath = "";
+    int bpmDetectionOffsetMS { 0 };
+
     float UImusicPreviewStart = 0;
     float UImusicPreviewStop = 15;
 
+    TempoAnalyzer bpmAnalyzer;
+    TextureCache artCache { constants::coverArtMaxSize };
+
+    // per window memory usage, refreshed about once a second while shown or tracing
+    std::vector<std::pair<std::string, EditWindow::MemoryUsage>> memoryUsages;
+    Uint32 memoryUsageTicks { 0 };
+
     std::queue<int> availableWindowIDs;
     std::vector<EditWindow> editWindows;
 
@@ -9,7 +9,7 @@ namespace menubar {
 void showMenuBar(ImFont * menuFont, SDL_Renderer * renderer, AudioSystem * audioSystem, EditWindowManager & editWindowManager);
 std::string showFileMenu(SDL_Renderer * renderer, AudioSystem * audioSystem, EditWindowManager & editWindowManager);
 void showEditMenu(EditWindowManager & editWindowManager);
-void showOptionMenu();
+void showOptionMenu(EditWindowManager & editWindowManager);
 
 }
 
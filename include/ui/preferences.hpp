@@ -1,6 +1,7 @@
 #ifndef PREFERENCES_HPP
 #define PREFERENCES_HPP
 
+#include <cstddef>
 #include <list>
 #include <string>
 
@@ -26,10 +27,15 @@ class Preferences {
         void addMostRecentFile(std::string path);
 
         bool isNotesoundEnabled() const;
+        bool isNotesoundMixed() const;
+        bool isAudioScrubbed() const;
+        bool isMetronomeEnabled() const;
+        bool isWaveformShown() const;
         bool isDarkTheme () const;
         void setDarkTheme(bool dark);
 
         bool getCopyArtAndMusic() const;
+        size_t getUndoHistoryBytes() const;
 
         std::string getInputDir() const;
         std::string getSaveDir() const;
@@ -45,9 +51,16 @@ class Preferences {
         bool showPreferences = false;
 
         bool enableNotesound = true;
+        bool mixNotesound = false;
+        bool scrubAudio = true;
+        bool metronome = false;
+        bool showWaveform = true;
 
         bool darkTheme = true;
 
+        // memory each chart's undo history may hold before its oldest edits are forgotten
+        int undoHistoryMB = 64;
+
         std::string inputDir;
         std::string saveDir;
 
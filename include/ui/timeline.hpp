@@ -2,7 +2,9 @@
 #define TIMELINE_HPP
 
 #include "actions/editaction.hpp"
+#include "actions/edithistory.hpp"
 #include "config/chartinfo.hpp"
+#include "config/noteselection.hpp"
 #include "config/songposition.hpp"
 
 #include "imgui.h"
@@ -19,6 +21,7 @@ class AudioSystem;
 
 namespace utils {
     void updateAudioPosition(AudioSystem * audioSystem, const SongPosition & songpos, int musicSourceIdx);
+    void scrubAudioPosition(AudioSystem * audioSystem, const SongPosition & songpos, int musicSourceIdx);
 }
 
 struct Timeline {
@@ -26,19 +29,25 @@ struct Timeline {
 
     void showContents(int musicSourceIdx, bool focused, bool & unsaved, AudioSystem * audioSystem, ChartInfo & chartinfo, SongPosition & songpos, std::vector<bool> & keysPressed);
 
+    void pushAction(const std::shared_ptr<EditAction> & action);
+
     int getUndoStackSize() const;
     int getRedoStackSize() const;
 
+    size_t getHistoryMemoryUsage() const;
+    size_t getClipboardMemoryUsage() const;
+
     void showBeatsplit();
     void showCurrentBeat(int musicSourceIdx, ChartInfo & chartinfo, SongPosition & songpos, AudioSystem * audioSystem) const;
     void showBeatpos(const SongPosition & songpos) const;
     void showZoom(bool focused);
+    void showMinimap(int musicSourceIdx, ChartInfo & chartinfo, SongPosition & songpos, AudioSystem * audioSystem) const;
     void showSequencer(bool focused, ChartInfo & chartinfo, SongPosition & songpos);
 
     void checkResetClicks();
     void checkUpdatedBeat(bool focused, int musicSourceIdx, ChartInfo & chartinfo, SongPosition & songpos, AudioSystem * audioSystem) const;
-    void prepUpdateEntity(bool focused, const std::string & addItemPopup, const SongPosition & songpos);
-    void setEntityType(bool focused, const std::string & addItemPopup, const SongPosition & songpos);
+    void prepUpdateEntity(bool focused, const std::string & addItemPopup, const ChartInfo & chartinfo, const SongPosition & songpos);
+    void setEntityType(bool focused, const std::string & addItemPopup, const ChartInfo & chartinfo, const SongPosition & songpos);
 
     void checkEditActions(bool focused, bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos, std::vector<bool> & keysPressed);
     void editCopy(const ChartInfo & chartinfo);
@@ -47,6 +56,9 @@ struct Timeline {
     void editShiftNotes(bool & unsaved, ChartInfo & chartinfo, const std::vector<bool> & keysPressed);
     void editDelete(bool & unsaved, ChartInfo & chartinfo);
     void editPaste(bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos);
+    void editSelectAll(const ChartInfo & chartinfo);
+    void editQuantize(bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos);
+    void clearSelection();
 
     void showAddItem(bool & unsaved, ChartInfo & chartinfo, SongPosition & songpos, std::vector <bool> & keysPressed);
     void showTopMidNote(bool & unsaved, char * addedItem, ChartInfo & chartinfo, const SongPosition & songpos);
@@ -72,6 +84,8 @@ struct Timeline {
     bool activatePaste { false };
     bool activateCut { false };
     bool activateFlip { false };
+    bool activateSelectAll { false };
+    bool activateQuantize { false };
 
     int currentBeatsplit { 4 };
     int clickedItemType { 0 };
@@ -93,10 +107,14 @@ struct Timeline {
     ImGuiInputTextFlags addItemFlags { 0 };
     ImGuiInputTextCallbackData addItemCallbackData;
 
-    std::stack<std::shared_ptr<EditAction>> undoStack;
-    std::stack<std::shared_ptr<EditAction>> redoStack;
+    EditHistory history;
+
+    // the items edit actions apply to; a shift-drag range fills it with the items inside
+    NoteSelection selection;
 
     std::list<std::shared_ptr<NoteSequenceItem>> copiedItems;
+    int copiedItemTypeStart { 0 };
+    int copiedItemTypeEnd { 0 };
 };
 
 #endif // TIMELINE_HPP
@@ -14,6 +14,9 @@ constexpr ImVec2 minFDSize { SCREEN_WIDTH/2.f, SCREEN_HEIGHT/2.f };
 constexpr ImVec2 newEditWindowSize { 600, 570 };
 constexpr ImVec2 editWindowSize { 640, 480 };
 
+// cover art is downscaled to about the largest size the chart data panel shows it at
+constexpr int coverArtMaxSize { 512 };
+
 }
 
 #endif
@@ -18,3 +18,7 @@ void DeleteItemsAction::undoAction(EditWindow * editWindow) {
 void DeleteItemsAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.deleteItems(startBeat, endBeat, itemTypeStart, itemTypeEnd);
 }
+
+size_t DeleteItemsAction::getMemoryUsage() const {
+    return sizeof(*this) + NoteSequence::getItemsMemoryUsage(items);
+}
@@ -16,3 +16,7 @@ void DeleteNoteAction::undoAction(EditWindow * editWindow) {
 void DeleteNoteAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.deleteItem(absBeat, itemType);
 }
+
+size_t DeleteNoteAction::getMemoryUsage() const {
+    return sizeof(*this) + utils::getStringMemoryUsage(displayText);
+}
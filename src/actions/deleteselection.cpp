@@ -0,0 +1,18 @@
+#include "actions/deleteselection.hpp"
+#include "ui/editwindow.hpp"
+
+DeleteSelectionAction::DeleteSelectionAction(const std::list<std::shared_ptr<NoteSequenceItem>> & items)
+    : items(items) {}
+
+void DeleteSelectionAction::undoAction(EditWindow * editWindow) {
+    editWindow->chartinfo.notes.restoreItems(items, editWindow->songpos.absBeat);
+}
+
+void DeleteSelectionAction::redoAction(EditWindow * editWindow) {
+    editWindow->chartinfo.notes.reconcileItems(items);
+    editWindow->chartinfo.notes.deleteItems(items);
+}
+
+size_t DeleteSelectionAction::getMemoryUsage() const {
+    return sizeof(*this) + NoteSequence::getItemsMemoryUsage(items);
+}
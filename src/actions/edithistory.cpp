@@ -0,0 +1,67 @@
+#include "actions/edithistory.hpp"
+
+void EditHistory::push(const std::shared_ptr<EditAction> & action, size_t byteBudget) {
+    while(entries.size() > cursor) {
+        bytes -= entries.back().bytes;
+        entries.pop_back();
+    }
+
+    entries.push_back({ action, 0 });
+    measure(entries.back());
+    cursor++;
+
+    // the newest action is always kept, however large
+    while(bytes > byteBudget && entries.size() > 1) {
+        bytes -= entries.front().bytes;
+        entries.pop_front();
+
+        cursor--;
+        forgotten++;
+    }
+}
+
+bool EditHistory::undo(EditWindow * editWindow) {
+    if(cursor == 0) {
+        return false;
+    }
+
+    auto & entry { entries[--cursor] };
+    entry.action->undoAction(editWindow);
+    measure(entry);
+
+    return true;
+}
+
+bool EditHistory::redo(EditWindow * editWindow) {
+    if(cursor == entries.size()) {
+        return false;
+    }
+
+    auto & entry { entries[cursor++] };
+    entry.action->redoAction(editWindow);
+    measure(entry);
+
+    return true;
+}
+
+size_t EditHistory::getUndoCount() const {
+    return cursor;
+}
+
+size_t EditHistory::getRedoCount() const {
+    return entries.size() - cursor;
+}
+
+size_t EditHistory::getPosition() const {
+    return forgotten + cursor;
+}
+
+size_t EditHistory::getMemoryUsage() const {
+    return bytes;
+}
+
+void EditHistory::measure(Entry & entry) {
+    bytes -= entry.bytes;
+    entry.bytes = sizeof(Entry) + entry.action->getMemoryUsage();
+    bytes += entry.bytes;
+}
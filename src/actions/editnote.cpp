@@ -14,3 +14,7 @@ void EditNoteAction::undoAction(EditWindow * editWindow) {
 void EditNoteAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.editNote(absBeat, itemType, newDisplayText);
 }
+
+size_t EditNoteAction::getMemoryUsage() const {
+    return sizeof(*this) + utils::getStringMemoryUsage(oldDisplayText) + utils::getStringMemoryUsage(newDisplayText);
+}
@@ -13,3 +13,7 @@ void EditSkipAction::undoAction(EditWindow * editWindow) {
 void EditSkipAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.editSkip(absBeat, newSkipbeats);
 }
+
+size_t EditSkipAction::getMemoryUsage() const {
+    return sizeof(*this);
+}
@@ -1,12 +1,9 @@
 #include "actions/flipnote.hpp"
 #include "ui/editwindow.hpp"
 
-FlipNoteAction::FlipNoteAction(int minItemType, int maxItemType, double startBeat, double endBeat, std::string_view keyboardLayout)
-    : minItemType(minItemType)
-    , maxItemType(maxItemType)
-    , startBeat(startBeat)
-    , endBeat(endBeat)
-    , keyboardLayout(keyboardLayout) {}
+FlipNoteAction::FlipNoteAction(std::string_view keyboardLayout, const std::list<std::shared_ptr<NoteSequenceItem>> & items)
+    : keyboardLayout(keyboardLayout)
+    , items(items) {}
 
 void FlipNoteAction::undoAction(EditWindow * editWindow) {
     // undo/redo is the same behavior
@@ -14,5 +11,10 @@ void FlipNoteAction::undoAction(EditWindow * editWindow) {
 }
 
 void FlipNoteAction::redoAction(EditWindow * editWindow) {
-    editWindow->chartinfo.notes.flipNotes(keyboardLayout, startBeat, endBeat, minItemType, maxItemType);
+    editWindow->chartinfo.notes.reconcileItems(items);
+    editWindow->chartinfo.notes.flipItems(keyboardLayout, items);
+}
+
+size_t FlipNoteAction::getMemoryUsage() const {
+    return sizeof(*this) + utils::getStringMemoryUsage(keyboardLayout) + NoteSequence::getItemsMemoryUsage(items);
 }
@@ -28,3 +28,7 @@ void InsertItemsAction::redoAction(EditWindow * editWindow) {
             itemTypeEnd, editWindow->songpos.timeinfo, itemsInserted);
     }
 }
+
+size_t InsertItemsAction::getMemoryUsage() const {
+    return sizeof(*this) + NoteSequence::getItemsMemoryUsage(itemsInserted) + NoteSequence::getItemsMemoryUsage(itemsDeleted);
+}
@@ -16,3 +16,7 @@ void PlaceNoteAction::undoAction(EditWindow * editWindow) {
 void PlaceNoteAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.addNote(absBeat, editWindow->songpos.absBeat, beatDuration,beatpos, endBeatpos, itemType, displayText);
 }
+
+size_t PlaceNoteAction::getMemoryUsage() const {
+    return sizeof(*this) + utils::getStringMemoryUsage(displayText);
+}
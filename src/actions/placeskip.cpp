@@ -18,3 +18,7 @@ void PlaceSkipAction::redoAction(EditWindow * editWindow) {
     auto skip = editWindow->chartinfo.notes.addSkip(absBeat, editWindow->songpos.absBeat, skipBeats, beatDuration, beatpos, endBeatpos);
     editWindow->songpos.addSkip(skip);
 }
+
+size_t PlaceSkipAction::getMemoryUsage() const {
+    return sizeof(*this);
+}
@@ -15,3 +15,7 @@ void PlaceStopAction::undoAction(EditWindow * editWindow) {
 void PlaceStopAction::redoAction(EditWindow * editWindow) {
     editWindow->chartinfo.notes.addStop(absBeat, editWindow->songpos.absBeat, beatDuration, beatpos, endBeatpos);
 }
+
+size_t PlaceStopAction::getMemoryUsage() const {
+    return sizeof(*this);
+}
@@ -0,0 +1,52 @@
+#include "actions/quantizenotes.hpp"
+#include "ui/editwindow.hpp"
+
+QuantizeNotesAction::QuantizeNotesAction(const std::vector<Move> & moves)
+    : moves(moves) {}
+
+void QuantizeNotesAction::undoAction(EditWindow * editWindow) {
+    auto & notes { editWindow->chartinfo.notes };
+
+    for(auto & move : moves) {
+        if(move.item->deleted) {
+            if(auto replacementItem { notes.findItem(*move.item) }) {
+                move.item = replacementItem;
+            } else {
+                continue;
+            }
+        }
+
+        notes.moveItem(move.item, move.fromBeat, move.fromBeatEnd, move.fromBeatpos, move.fromEndBeatpos);
+    }
+
+    notes.sortItems();
+}
+
+void QuantizeNotesAction::redoAction(EditWindow * editWindow) {
+    auto & notes { editWindow->chartinfo.notes };
+
+    for(auto & move : moves) {
+        if(move.item->deleted) {
+            if(auto replacementItem { notes.findItem(*move.item) }) {
+                move.item = replacementItem;
+            } else {
+                continue;
+            }
+        }
+
+        notes.moveItem(move.item, move.toBeat, move.toBeatEnd, move.toBeatpos, move.toEndBeatpos);
+    }
+
+    notes.sortItems();
+}
+
+size_t QuantizeNotesAction::getMemoryUsage() const {
+    size_t bytes { sizeof(*this) + moves.capacity() * sizeof(Move) };
+    for(const auto & move : moves) {
+        if(move.item.use_count() == 1) {
+            bytes += NoteSequence::getItemMemoryUsage(move.item);
+        }
+    }
+
+    return bytes;
+}
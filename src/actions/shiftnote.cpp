@@ -42,25 +42,9 @@ void ShiftNoteAction::redoAction(EditWindow * editWindow) {
 void ShiftNoteAction::reconcileDeletedItems(const EditWindow * editWindow) {
     // if any items were deleted, try to find a replacement with matching beat / note
     // otherwise, just delete the item
-    for(auto itemIter = items.begin(); itemIter != items.end();) {
-        auto item = *itemIter;
-
-        if(item && item->deleted) {
-            std::shared_ptr<NoteSequenceItem> replacementItem { nullptr };
-            for(auto note : editWindow->chartinfo.notes.myItems) {
-                if(note && (*note == *item)) {
-                    replacementItem = note;
-                    break;
-                }
-            }
+    editWindow->chartinfo.notes.reconcileItems(items);
+}
 
-            itemIter = items.erase(itemIter);
-            if(replacementItem) {
-                itemIter = items.insert(itemIter, replacementItem);
-                itemIter++;
-            }
-        } else {
-            itemIter++;
-        }
-    }
+size_t ShiftNoteAction::getMemoryUsage() const {
+    return sizeof(*this) + utils::getStringMemoryUsage(keyboardLayout) + NoteSequence::getItemsMemoryUsage(items);
 }
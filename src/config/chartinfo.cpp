@@ -3,6 +3,7 @@
 #include "config/notemaps.hpp"
 #include "config/songposition.hpp"
 #include "config/utils.hpp"
+#include "systems/profiler.hpp"
 #include "ui/editwindow.hpp"
 
 #include <fstream>
@@ -16,6 +17,8 @@ ChartInfo::ChartInfo(int level, std::string_view typist, std::string_view keyboa
     , difficulty(difficulty) {}
 
 bool ChartInfo::loadChart(const fs::path & chartPath, SongPosition & songpos) {
+    PROFILE_SCOPE(CHART_LOAD);
+
     savePath = chartPath;
 
     ordered_json chartinfoJSON;
@@ -220,6 +223,8 @@ ordered_json ChartInfo::saveChartTimeInfo(SongPosition & songpos) const {
 }
 
 void ChartInfo::saveChart(const fs::path & chartPath, SongPosition & songpos) {
+    PROFILE_SCOPE(CHART_SAVE);
+
     savePath = chartPath;
 
     auto chartinfoJSON = saveChartMetadata();
@@ -0,0 +1,70 @@
+#include "config/notedensity.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void NoteDensity::add(NoteSequenceItem::SequencerItemType lane, double absBeat) {
+    auto bucket { getBucket(absBeat) };
+    if(bucket >= buckets.size()) {
+        buckets.resize(bucket + 1, std::array<int, NUM_LANES> {});
+    }
+
+    int & count { buckets[bucket][static_cast<size_t>(lane)] };
+    count++;
+
+    if(!maxCountStale) {
+        maxCount = std::max(maxCount, count);
+    }
+}
+
+void NoteDensity::remove(NoteSequenceItem::SequencerItemType lane, double absBeat) {
+    auto bucket { getBucket(absBeat) };
+    if(bucket >= buckets.size()) {
+        return;
+    }
+
+    int & count { buckets[bucket][static_cast<size_t>(lane)] };
+    if(count <= 0) {
+        return;
+    }
+
+    if(count == maxCount) {
+        maxCountStale = true;
+    }
+
+    count--;
+
+    // drop empty buckets off the end so the minimap's extent follows the last item
+    while(!buckets.empty() && std::all_of(buckets.back().begin(), buckets.back().end(), [](int laneCount) { return laneCount == 0; })) {
+        buckets.pop_back();
+    }
+}
+
+size_t NoteDensity::getBucketCount() const {
+    return buckets.size();
+}
+
+int NoteDensity::getCount(size_t lane, size_t bucket) const {
+    return bucket < buckets.size() && lane < NUM_LANES ? buckets[bucket][lane] : 0;
+}
+
+int NoteDensity::getMaxCount() {
+    if(maxCountStale) {
+        maxCount = 0;
+        for(const auto & bucket : buckets) {
+            maxCount = std::max(maxCount, *std::max_element(bucket.begin(), bucket.end()));
+        }
+
+        maxCountStale = false;
+    }
+
+    return maxCount;
+}
+
+size_t NoteDensity::getMemoryUsage() const {
+    return buckets.capacity() * sizeof(std::array<int, NUM_LANES>);
+}
+
+size_t NoteDensity::getBucket(double absBeat) {
+    return static_cast<size_t>(std::max(0.0, std::floor(absBeat / BUCKET_BEATS)));
+}
@@ -0,0 +1,121 @@
+#include "config/noteselection.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+bool NoteSelection::empty() const {
+    return items.empty();
+}
+
+size_t NoteSelection::size() const {
+    return items.size();
+}
+
+void NoteSelection::clear() {
+    items.clear();
+}
+
+bool NoteSelection::contains(const std::shared_ptr<NoteSequenceItem> & item) const {
+    return item && !item->deleted && std::binary_search(items.begin(), items.end(), item, compare);
+}
+
+void NoteSelection::add(const std::shared_ptr<NoteSequenceItem> & item) {
+    auto iter { std::lower_bound(items.begin(), items.end(), item, compare) };
+    if(item && (iter == items.end() || *iter != item)) {
+        items.insert(iter, item);
+    }
+}
+
+void NoteSelection::remove(const std::shared_ptr<NoteSequenceItem> & item) {
+    auto iter { std::lower_bound(items.begin(), items.end(), item, compare) };
+    if(iter != items.end() && *iter == item) {
+        items.erase(iter);
+    }
+}
+
+void NoteSelection::toggle(const std::shared_ptr<NoteSequenceItem> & item) {
+    if(contains(item)) {
+        remove(item);
+    } else {
+        add(item);
+    }
+}
+
+void NoteSelection::add(const std::list<std::shared_ptr<NoteSequenceItem>> & addedItems) {
+    // merge rather than insert one by one, ranges come from the store already in order
+    std::vector<std::shared_ptr<NoteSequenceItem>> sortedItems(addedItems.begin(), addedItems.end());
+    std::sort(sortedItems.begin(), sortedItems.end(), compare);
+
+    std::vector<std::shared_ptr<NoteSequenceItem>> merged;
+    merged.reserve(items.size() + sortedItems.size());
+    std::set_union(items.begin(), items.end(), sortedItems.begin(), sortedItems.end(), std::back_inserter(merged), compare);
+
+    items.swap(merged);
+}
+
+void NoteSelection::remove(const std::list<std::shared_ptr<NoteSequenceItem>> & removedItems) {
+    std::vector<std::shared_ptr<NoteSequenceItem>> sortedItems(removedItems.begin(), removedItems.end());
+    std::sort(sortedItems.begin(), sortedItems.end(), compare);
+
+    std::vector<std::shared_ptr<NoteSequenceItem>> remaining;
+    remaining.reserve(items.size());
+    std::set_difference(items.begin(), items.end(), sortedItems.begin(), sortedItems.end(), std::back_inserter(remaining), compare);
+
+    items.swap(remaining);
+}
+
+void NoteSelection::removeDeleted() {
+    items.erase(std::remove_if(items.begin(), items.end(), [](const auto & item) { return item->deleted; }), items.end());
+}
+
+void NoteSelection::sort() {
+    std::sort(items.begin(), items.end(), compare);
+}
+
+std::list<std::shared_ptr<NoteSequenceItem>> NoteSelection::getItems() const {
+    std::list<std::shared_ptr<NoteSequenceItem>> selectedItems;
+    for(const auto & item : items) {
+        if(!item->deleted) {
+            selectedItems.push_back(item);
+        }
+    }
+
+    return selectedItems;
+}
+
+double NoteSelection::getFirstBeat() const {
+    return items.empty() ? 0.0 : items.front()->absBeat;
+}
+
+double NoteSelection::getLastBeat() const {
+    double lastBeat { 0.0 };
+    for(const auto & item : items) {
+        lastBeat = std::max(lastBeat, item->beatEnd);
+    }
+
+    return lastBeat;
+}
+
+int NoteSelection::getMinItemType() const {
+    auto minItem { std::min_element(items.begin(), items.end(), [](const auto & lhs, const auto & rhs) { return lhs->itemType < rhs->itemType; }) };
+    return minItem == items.end() ? 0 : static_cast<int>((*minItem)->itemType);
+}
+
+int NoteSelection::getMaxItemType() const {
+    auto maxItem { std::max_element(items.begin(), items.end(), [](const auto & lhs, const auto & rhs) { return lhs->itemType < rhs->itemType; }) };
+    return maxItem == items.end() ? 0 : static_cast<int>((*maxItem)->itemType);
+}
+
+size_t NoteSelection::getMemoryUsage() const {
+    return items.capacity() * sizeof(std::shared_ptr<NoteSequenceItem>);
+}
+
+bool NoteSelection::compare(const std::shared_ptr<NoteSequenceItem> & lhs, const std::shared_ptr<NoteSequenceItem> & rhs) {
+    // items at the same beat (in different lanes) are told apart by address; lanes can change under a shift
+    if(lhs->absBeat != rhs->absBeat) {
+        return lhs->absBeat < rhs->absBeat;
+    }
+
+    return std::less<const NoteSequenceItem *>()(lhs.get(), rhs.get());
+}
@@ -1,8 +1,14 @@
 #include "config/notesequence.hpp"
 
 #include "config/notemaps.hpp"
+#include "resources/waveform.hpp"
+#include "systems/profiler.hpp"
 
 void NoteSequence::update(double songBeat, AudioSystem * audioSystem, bool notesoundEnabled) {
+    PROFILE_SCOPE(NOTES_UPDATE);
+
+    int keypressSound { -1 };
+
     for(const auto & item : myItems) {
         switch(item->itemType) {
             case NoteSequenceItem::SequencerItemType::TOP_NOTE:
@@ -14,7 +20,11 @@ void NoteSequence::update(double songBeat, AudioSystem * audioSystem, bool notes
                     item->passed = true;
 
                     if(notesoundEnabled) {
-                        audioSystem->playSound("keypress");
+                        if(keypressSound < 0) {
+                            keypressSound = audioSystem->getSoundHandle("keypress");
+                        }
+
+                        audioSystem->playSound(keypressSound);
                     }
                 }
                 break;
@@ -26,6 +36,24 @@ void NoteSequence::update(double songBeat, AudioSystem * audioSystem, bool notes
     }
 }
 
+std::vector<double> NoteSequence::getNoteTimes(const std::vector<Timeinfo> & timeinfo, int offsetMS) const {
+    std::vector<double> noteTimes;
+
+    for(const auto & item : myItems) {
+        switch(item->itemType) {
+            case NoteSequenceItem::SequencerItemType::TOP_NOTE:
+            case NoteSequenceItem::SequencerItemType::MID_NOTE:
+            case NoteSequenceItem::SequencerItemType::BOT_NOTE:
+                noteTimes.push_back(utils::calculateAbsTime(item->absBeat, timeinfo) + (offsetMS / 1000.0));
+                break;
+            default:
+                break;
+        }
+    }
+
+    return noteTimes;
+}
+
 void NoteSequence::resetPassed(double songBeat) {
     for(const auto & item : myItems) {
         switch(item->itemType) {
@@ -55,6 +83,8 @@ void NoteSequence::addNote(double absBeat, double songBeat, double beatDuration,
     std::shared_ptr<NoteSequenceItem> newNote = std::make_shared<Note>(itemType, passed, absBeat, absBeat + beatDuration, beatpos, endBeatpos,
         noteType, Note::NoteSplit::EIGHTH, displayText);
     myItems.push_back(newNote);
+    density.add(itemType, absBeat);
+    revision++;
 
     std::sort(myItems.begin(), myItems.end());
 
@@ -100,6 +130,7 @@ void NoteSequence::addStop(double absBeat, double songBeat, double beatDuration,
     auto newStop { std::make_shared<Stop>(absBeat, beatDuration, passed, beatpos, endBeatpos) };
     newStop->displayText = std::to_string(beatDuration);
     myItems.push_back(newStop);
+    density.add(NoteSequenceItem::SequencerItemType::STOP, absBeat);
 
     std::sort(myItems.begin(), myItems.end());
 }
@@ -109,6 +140,7 @@ std::shared_ptr<Skip> NoteSequence::addSkip(double absBeat, double songBeat, dou
     auto newSkip { std::make_shared<Skip>(absBeat, skipTime, passed, beatDuration, beatpos, endBeatpos) };
     newSkip->displayText = std::to_string(skipTime);
     myItems.push_back(newSkip);
+    density.add(NoteSequenceItem::SequencerItemType::SKIP, absBeat);
 
     std::sort(myItems.begin(), myItems.end());
 
@@ -130,10 +162,13 @@ void NoteSequence::editSkip(double absBeat, double skipTime) {
 }
 
 void NoteSequence::flipNotes(const std::string & keyboardLayout, double startBeat, double endBeat, int minItemType, int maxItemType) {
+    flipItems(keyboardLayout, getItems(startBeat, endBeat, minItemType, maxItemType));
+}
+
+void NoteSequence::flipItems(const std::string & keyboardLayout, const std::list<std::shared_ptr<NoteSequenceItem>> & items) {
     if(notemaps::KEYBOARD_FLIP_MAPS.find(keyboardLayout) != notemaps::KEYBOARD_FLIP_MAPS.end()) {
         auto & flipMap = notemaps::KEYBOARD_FLIP_MAPS.at(keyboardLayout);
 
-        auto items = getItems(startBeat, endBeat, minItemType, maxItemType);
         for(auto item: items) {
             switch(item->itemType) {
                 case NoteSequenceItem::SequencerItemType::TOP_NOTE:
@@ -231,6 +266,11 @@ bool NoteSequence::shiftNoteSequenceItem(ShiftNoteAction::ShiftDirection shiftDi
                     item->itemType = NoteSequenceItem::SequencerItemType::TOP_NOTE;
                 }
 
+                if(item->itemType != itemType) {
+                    density.remove(itemType, item->absBeat);
+                    density.add(item->itemType, item->absBeat);
+                }
+
                 auto newKey = keyboardLayoutMap[newRow][newCol];
                 keyFrequencies[itemKey] -= 1;
                 item->displayText = newKey;
@@ -247,20 +287,33 @@ bool NoteSequence::shiftNoteSequenceItem(ShiftNoteAction::ShiftDirection shiftDi
 std::list<std::shared_ptr<NoteSequenceItem>> NoteSequence::getItems(double startBeat, double endBeat, int minItemType, int maxItemType) const {
     std::list<std::shared_ptr<NoteSequenceItem>> currItems;
 
-    std::for_each(myItems.begin(), myItems.end(), [&](auto seqItem) {
-        int seqItemType = static_cast<int>(seqItem->itemType);
+    // items are kept sorted by start beat
+    auto first { std::lower_bound(myItems.begin(), myItems.end(), startBeat,
+        [](const std::shared_ptr<NoteSequenceItem> & item, double beat) { return item->absBeat < beat; }) };
 
-        if(seqItemType >= minItemType && seqItemType <= maxItemType && startBeat <= seqItem->absBeat && seqItem->absBeat <= endBeat) {
-            currItems.push_back(seqItem);
-        } else if(endBeat <= seqItem->absBeat) {
-            return;
+    for(auto iter = first; iter != myItems.end() && (*iter)->absBeat <= endBeat; iter++) {
+        int seqItemType = static_cast<int>((*iter)->itemType);
+        if(seqItemType >= minItemType && seqItemType <= maxItemType) {
+            currItems.push_back(*iter);
         }
-    });
+    }
 
     return currItems;
 }
 
-std::shared_ptr<NoteSequenceItem> NoteSequence::containsItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType) {
+std::list<std::shared_ptr<NoteSequenceItem>> NoteSequence::getKeyItems(const std::string & key) const {
+    std::list<std::shared_ptr<NoteSequenceItem>> keyItems;
+
+    for(const auto & item : myItems) {
+        if(item->itemType <= NoteSequenceItem::SequencerItemType::BOT_NOTE && item->displayText == key) {
+            keyItems.push_back(item);
+        }
+    }
+
+    return keyItems;
+}
+
+std::shared_ptr<NoteSequenceItem> NoteSequence::containsItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType) const {
     for(auto seqItem : myItems) {
         if(seqItem->itemType == itemType && absBeat >= seqItem->absBeat &&
             (absBeat < seqItem->beatEnd || (seqItem->absBeat == seqItem->beatEnd && absBeat <= seqItem->beatEnd)))
@@ -272,6 +325,47 @@ std::shared_ptr<NoteSequenceItem> NoteSequence::containsItemAt(double absBeat, N
     return nullptr;
 }
 
+std::shared_ptr<NoteSequenceItem> NoteSequence::getItemAt(double absBeat, NoteSequenceItem::SequencerItemType itemType) const {
+    auto iter { std::lower_bound(myItems.begin(), myItems.end(), absBeat,
+        [](const std::shared_ptr<NoteSequenceItem> & item, double beat) { return item->absBeat < beat; }) };
+
+    for(; iter != myItems.end() && (*iter)->absBeat == absBeat; iter++) {
+        if((*iter)->itemType == itemType) {
+            return *iter;
+        }
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<NoteSequenceItem> NoteSequence::findItem(const NoteSequenceItem & item) const {
+    auto iter { std::lower_bound(myItems.begin(), myItems.end(), item.absBeat,
+        [](const std::shared_ptr<NoteSequenceItem> & seqItem, double beat) { return seqItem->absBeat < beat; }) };
+
+    for(; iter != myItems.end() && (*iter)->absBeat == item.absBeat; iter++) {
+        if(**iter == item) {
+            return *iter;
+        }
+    }
+
+    return nullptr;
+}
+
+void NoteSequence::reconcileItems(std::list<std::shared_ptr<NoteSequenceItem>> & items) const {
+    for(auto itemIter = items.begin(); itemIter != items.end();) {
+        if(*itemIter && (*itemIter)->deleted) {
+            if(auto replacementItem { findItem(**itemIter) }) {
+                *itemIter = replacementItem;
+                itemIter++;
+            } else {
+                itemIter = items.erase(itemIter);
+            }
+        } else {
+            itemIter++;
+        }
+    }
+}
+
 int NoteSequence::getLaneItemCount(NoteSequenceItem::SequencerItemType lane) const {
     switch(lane) {
         case NoteSequenceItem::SequencerItemType::TOP_NOTE:
@@ -352,45 +446,29 @@ void NoteSequence::insertItems(double insertBeat, double songBeat, int minItemTy
     }
 }
 
- void NoteSequence::deleteItems(double startBeat, double endBeat, int minItemType, int maxItemType) {
-    for(auto iter = myItems.begin(); iter != myItems.end();) {
-        bool removeNote = false;
-        const auto & seqItem = *iter;
+void NoteSequence::deleteItems(double startBeat, double endBeat, int minItemType, int maxItemType) {
+    // only the range is visited, and the items after it are moved down once
+    auto first { std::lower_bound(myItems.begin(), myItems.end(), startBeat,
+        [](const std::shared_ptr<NoteSequenceItem> & item, double beat) { return item->absBeat < beat; }) };
+    auto last { std::upper_bound(first, myItems.end(), endBeat,
+        [](double beat, const std::shared_ptr<NoteSequenceItem> & item) { return beat < item->absBeat; }) };
 
+    auto removed { std::remove_if(first, last, [&](const std::shared_ptr<NoteSequenceItem> & seqItem) {
         auto seqItemType = static_cast<int>(seqItem->itemType);
+        if(seqItemType < minItemType || seqItemType > maxItemType) {
+            return false;
+        }
 
-        if(seqItemType >= minItemType && seqItemType <= maxItemType && startBeat <= seqItem->absBeat && seqItem->absBeat <= endBeat) {
-            switch(seqItem->itemType) {
-                case NoteSequenceItem::SequencerItemType::TOP_NOTE:
-                    numTopNotes--;
-                    removeNote = true;
-                    break;
-                case NoteSequenceItem::SequencerItemType::MID_NOTE:
-                    numMidNotes--;
-                    removeNote = true;
-                    break;
-                case NoteSequenceItem::SequencerItemType::BOT_NOTE:
-                    numBotNotes--;
-                    removeNote = true;
-                    break;
-                default:
-                    break;
-            }
-
-            if(removeNote) {
-                keyFrequencies[seqItem->displayText] -= 1;
-                if(keyFrequencies[seqItem->displayText] == 0) {
-                    keyFrequencies.erase(seqItem->displayText);
-                }
-            }
+        removeItemCounts(*seqItem);
 
-            // in case dangling pointers in undo/redo stack refer to this item
-            seqItem->deleted = true;
+        // in case dangling pointers in undo/redo stack refer to this item
+        seqItem->deleted = true;
+        return true;
+    }) };
 
-            iter = myItems.erase(iter);
-        } else {
-            iter++;
-        }
+    if(removed != last) {
+        myItems.erase(removed, last);
+        revision++;
     }
 
     updateKeyFrequencies();
@@ -400,6 +478,100 @@ void NoteSequence::deleteItem(double absBeat, NoteSequenceItem::SequencerItemTyp
     deleteItems(absBeat, absBeat, static_cast<int>(itemType), static_cast<int>(itemType));
 }
 
+void NoteSequence::deleteItems(const std::list<std::shared_ptr<NoteSequenceItem>> & items) {
+    bool removedItems { false };
+    for(const auto & item : items) {
+        if(item && !item->deleted) {
+            removeItemCounts(*item);
+            item->deleted = true;
+            removedItems = true;
+        }
+    }
+
+    if(!removedItems) {
+        return;
+    }
+
+    // one pass over the store however many items go
+    myItems.erase(std::remove_if(myItems.begin(), myItems.end(), [](const auto & item) { return item->deleted; }), myItems.end());
+    revision++;
+
+    updateKeyFrequencies();
+}
+
+void NoteSequence::restoreItems(const std::list<std::shared_ptr<NoteSequenceItem>> & items, double songBeat) {
+    for(const auto & item : items) {
+        if(item && item->deleted) {
+            item->deleted = false;
+            item->passed = item->itemType <= NoteSequenceItem::SequencerItemType::BOT_NOTE && item->absBeat < songBeat;
+
+            myItems.push_back(item);
+            addItemCounts(*item);
+        }
+    }
+
+    sortItems();
+    updateKeyFrequencies();
+}
+
+void NoteSequence::moveItem(const std::shared_ptr<NoteSequenceItem> & item, double absBeat, double beatEnd, BeatPos beatpos, BeatPos endBeatpos) {
+    density.remove(item->itemType, item->absBeat);
+    density.add(item->itemType, absBeat);
+
+    item->absBeat = absBeat;
+    item->beatEnd = beatEnd;
+    item->beatpos = beatpos;
+    item->endBeatpos = endBeatpos;
+}
+
+void NoteSequence::sortItems() {
+    std::sort(myItems.begin(), myItems.end());
+    revision++;
+}
+
+void NoteSequence::addItemCounts(const NoteSequenceItem & item) {
+    density.add(item.itemType, item.absBeat);
+
+    switch(item.itemType) {
+        case NoteSequenceItem::SequencerItemType::TOP_NOTE:
+            numTopNotes++;
+            break;
+        case NoteSequenceItem::SequencerItemType::MID_NOTE:
+            numMidNotes++;
+            break;
+        case NoteSequenceItem::SequencerItemType::BOT_NOTE:
+            numBotNotes++;
+            break;
+        default:
+            return;
+    }
+
+    keyFrequencies[item.displayText] += 1;
+}
+
+void NoteSequence::removeItemCounts(const NoteSequenceItem & item) {
+    density.remove(item.itemType, item.absBeat);
+
+    switch(item.itemType) {
+        case NoteSequenceItem::SequencerItemType::TOP_NOTE:
+            numTopNotes--;
+            break;
+        case NoteSequenceItem::SequencerItemType::MID_NOTE:
+            numMidNotes--;
+            break;
+        case NoteSequenceItem::SequencerItemType::BOT_NOTE:
+            numBotNotes--;
+            break;
+        default:
+            return;
+    }
+
+    keyFrequencies[item.displayText] -= 1;
+    if(keyFrequencies[item.displayText] == 0) {
+        keyFrequencies.erase(item.displayText);
+    }
+}
+
 const std::pair<std::string, int> & NoteSequence::getKeyItemData(int frequencyRank) const {
     return keyFreqsSorted.at(frequencyRank);
 }
@@ -432,3 +604,102 @@ void NoteSequence::Get(int index, double** start, double** end, int* type, unsig
         *displayText = item->displayText.c_str();
     }
 }
+
+size_t NoteSequence::getMemoryUsage() const {
+    size_t bytes { myItems.capacity() * sizeof(std::shared_ptr<NoteSequenceItem>) };
+    for(const auto & item : myItems) {
+        bytes += getItemMemoryUsage(item);
+    }
+
+    // map nodes hold a key and three links each
+    for(const auto & [key, frequency] : keyFrequencies) {
+        bytes += sizeof(std::pair<const std::string, int>) + 4 * sizeof(void *) + utils::getStringMemoryUsage(key);
+    }
+
+    for(const auto & [key, frequency] : keyFreqsSorted) {
+        bytes += utils::getStringMemoryUsage(key);
+    }
+
+    return bytes + keyFreqsSorted.capacity() * sizeof(std::pair<std::string, int>) + density.getMemoryUsage();
+}
+
+size_t NoteSequence::getItemMemoryUsage(const std::shared_ptr<NoteSequenceItem> & item) {
+    if(!item) {
+        return 0;
+    }
+
+    size_t itemSize { sizeof(Note) };
+    switch(item->itemType) {
+        case NoteSequenceItem::SequencerItemType::STOP:
+            itemSize = sizeof(Stop);
+            break;
+        case NoteSequenceItem::SequencerItemType::SKIP:
+            itemSize = sizeof(Skip);
+            break;
+        default:
+            break;
+    }
+
+    // make_shared keeps the reference counts in the same allocation
+    return itemSize + 2 * sizeof(long) + utils::getStringMemoryUsage(item->displayText);
+}
+
+size_t NoteSequence::getItemsMemoryUsage(const std::list<std::shared_ptr<NoteSequenceItem>> & items) {
+    size_t bytes { 0 };
+    for(const auto & item : items) {
+        bytes += sizeof(item) + 2 * sizeof(void *);
+        if(item.use_count() == 1) {
+            bytes += getItemMemoryUsage(item);
+        }
+    }
+
+    return bytes;
+}
+
+void NoteSequence::GetItems(double firstFrame, double lastFrame, std::vector<ImSequencer::SequenceItem> & items) {
+    items.clear();
+
+    if(maxItemBeatsRevision != revision || maxItemBeatsCount != myItems.size()) {
+        maxItemBeats = 0.0;
+        for(const auto & item : myItems) {
+            maxItemBeats = std::max(maxItemBeats, item->beatEnd - item->absBeat);
+        }
+
+        maxItemBeatsRevision = revision;
+        maxItemBeatsCount = myItems.size();
+    }
+
+    // items are kept sorted by start beat, so only those starting at most the longest length before the range can reach it
+    auto first { std::lower_bound(myItems.begin(), myItems.end(), firstFrame - maxItemBeats,
+        [](const std::shared_ptr<NoteSequenceItem> & item, double beat) { return item->absBeat < beat; }) };
+    auto last { std::upper_bound(first, myItems.end(), lastFrame,
+        [](double beat, const std::shared_ptr<NoteSequenceItem> & item) { return beat < item->absBeat; }) };
+
+    for(auto iter = first; iter != last; iter++) {
+        const auto & item = *iter;
+        if(item->beatEnd >= firstFrame) {
+            items.push_back({ static_cast<int>(iter - myItems.begin()), &(item->absBeat), &(item->beatEnd),
+                static_cast<int>(item->itemType), item->displayText.c_str(), selection && selection->contains(item) });
+        }
+    }
+}
+
+void NoteSequence::setWaveform(const Waveform * waveform, const std::vector<Timeinfo> * timeinfo, int offsetMS) {
+    this->waveform = waveform;
+    waveformTimeinfo = timeinfo;
+    waveformOffsetMS = offsetMS;
+}
+
+void NoteSequence::setSelection(const NoteSelection * selection) {
+    this->selection = selection;
+}
+
+void NoteSequence::DrawBackground(ImDrawList * draw_list, const ImRect & rc, double firstFrame, float framePixelWidth, bool darkTheme) {
+    viewFirstBeat = firstFrame;
+    viewLastBeat = firstFrame + rc.GetWidth() / framePixelWidth;
+
+    if(waveform && waveformTimeinfo) {
+        ImU32 waveformCol = darkTheme ? 0x40FFFFFF : 0x50000000;
+        waveform->draw(draw_list, rc, firstFrame, framePixelWidth, *waveformTimeinfo, waveformOffsetMS, waveformCol);
+    }
+}
@@ -3,11 +3,12 @@
 #include <float.h>
 
 #include "config/songposition.hpp"
+#include "config/utils.hpp"
 
 #include "imgui.h"
 
 void SongPosition::start() {
-    songStart = SDL_GetPerformanceCounter();
+    songStart = getClock();
     currentSection = 0;
     prevSectionBeats = 0;
     prevSectionTime = 0;
@@ -38,7 +39,7 @@ void SongPosition::stop() {
 
 void SongPosition::update() {
     if(!paused && started) {
-        now = SDL_GetPerformanceCounter();
+        now = getClock();
         absTime = (((double)(now - songStart)) / SDL_GetPerformanceFrequency()) - (offsetMS / 1000.0);
 
         updateBeatPos();
@@ -122,7 +123,7 @@ void SongPosition::updateSkips() {
             beatSkipped = true;
 
             currSkipDuration = skips.at(currentSkip)->beatDuration * currSpb;
-            currSkipBegin = SDL_GetPerformanceCounter();
+            currSkipBegin = getClock();
             currSkipStartTimePosition = (static_cast<double>(currSkipBegin - songStart) / static_cast<double>(SDL_GetPerformanceFrequency())) - (offsetMS / 1000.0);
 
             currSkipTime = skips.at(currentSkip)->skipTime;
@@ -185,6 +186,7 @@ bool SongPosition::addSection(int newBeatsPerMeasure, double newBPM, double newI
 
     std::sort(timeinfo.begin(), timeinfo.end());
     prevSection = &(timeinfo.front());
+    timingRevision++;
 
     // update following section(s) time start after adding new section
     for(auto & section : timeinfo) {
@@ -230,6 +232,25 @@ bool SongPosition::removeSection(int sectionIndex) {
         }
     }
 
+    timingRevision++;
+    setSongBeatPosition(absBeat);
+
+    return true;
+}
+
+bool SongPosition::setSectionBPM(int sectionIndex, double newBPM) {
+    if(sectionIndex < 0 || sectionIndex >= (int)timeinfo.size()) {
+        return false;
+    }
+
+    timeinfo.at(sectionIndex).bpm = newBPM;
+
+    // following sections keep their beat positions, but now start at different times
+    for(auto i = static_cast<size_t>(sectionIndex) + 1; i < timeinfo.size(); i++) {
+        timeinfo.at(i).absTimeStart = timeinfo.at(i).calculateTimeStart(&timeinfo.at(i - 1));
+    }
+
+    timingRevision++;
     setSongBeatPosition(absBeat);
 
     return true;
@@ -270,24 +291,7 @@ void SongPosition::setSongTimePosition(double absTime) {
 
 void SongPosition::setSongBeatPosition(double absBeat) {
     if(!timeinfo.empty()) {
-        // calculate absTime from absBeat
-        double absBeatTime = 0;
-        double prevAbsBeatStart = 0.0;
-        double prevSpb = 60.0 / timeinfo.front().bpm;
-
-        for(auto const & tInfo : timeinfo) {
-            if(absBeat >= tInfo.absBeatStart) {
-                absBeatTime += prevSpb * (tInfo.absBeatStart - prevAbsBeatStart);
-
-                prevAbsBeatStart = tInfo.absBeatStart;
-                prevSpb = (60.0 / tInfo.bpm);
-            } else {
-                break;
-            }
-        }
-
-        // add the remainder
-        absBeatTime += prevSpb * (absBeat - prevAbsBeatStart);
+        double absBeatTime = utils::calculateAbsTime(absBeat, timeinfo);
         this->absBeat = absBeat;
         setSongTimePosition(absBeatTime);
 
@@ -295,6 +299,23 @@ void SongPosition::setSongBeatPosition(double absBeat) {
     }
 }
 
+bool SongPosition::wrapLoop(double loopStartTime, double loopEndTime) {
+    if(!started || paused || timeinfo.empty() || loopEndTime <= loopStartTime || absTime < loopEndTime) {
+        return false;
+    }
+
+    // keep the overshoot, so the clock runs on without a hitch
+    setSongTimePosition(loopStartTime + std::fmod(absTime - loopStartTime, loopEndTime - loopStartTime));
+    absBeat = prevSectionBeats + ((absTime - prevSectionTime) / currSpb);
+
+    beatSkipped = false;
+    beatSkiptimePassed = false;
+    bpmInterpolating = false;
+    resetCurrskip();
+
+    return true;
+}
+
 double SongPosition::calculateAbsBeat(BeatPos beatpos) {
     double absBeat { 0.0 };
     int prevSectionBeatsPerMeasure { 4 };
@@ -318,13 +339,25 @@ double SongPosition::calculateAbsBeat(BeatPos beatpos) {
     return absBeat;
 }
 
+Uint64 SongPosition::getClock() const {
+    Uint64 realElapsed { SDL_GetPerformanceCounter() - clockRealStart };
+    return clockStart + static_cast<Uint64>(static_cast<double>(realElapsed) * playbackRate);
+}
+
+void SongPosition::setPlaybackRate(double rate) {
+    // restart the clock from its current reading, so song time stays continuous
+    clockStart = getClock();
+    clockRealStart = SDL_GetPerformanceCounter();
+    playbackRate = rate;
+}
+
 void SongPosition::pause() {
-    pauseCounter = SDL_GetPerformanceCounter();
+    pauseCounter = getClock();
     paused = true;
 }
 
 void SongPosition::unpause() {
-    now = SDL_GetPerformanceCounter();
+    now = getClock();
     songStart += (now - pauseCounter);
 
     paused = false;
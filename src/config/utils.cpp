@@ -1,6 +1,5 @@
 #include <cmath>
 
-#include "actions/editaction.hpp"
 #include "config/utils.hpp"
 
 #include "imgui.h"
@@ -9,11 +8,6 @@
 
 namespace utils {
 
-void emptyActionStack(std::stack<std::shared_ptr<EditAction>> & stack) {
-    while(!stack.empty())
-        stack.pop();
-}
-
 // Helper to display a little (?) mark which shows a tooltip when hovered.
 // In your own code you may want to display an actual icon if you are using a merged icon fonts (see docs/FONTS.md)
 void HelpMarker(const char* desc) {
@@ -92,6 +86,49 @@ BeatPos calculateBeatpos(double absBeat, int currentBeatsplit, const std::vector
     return BeatPos(measure, measureSplit, split);
 }
 
+double calculateAbsTime(double absBeat, const std::vector<Timeinfo> & timeinfo) {
+    if(timeinfo.empty()) {
+        return 0.0;
+    }
+
+    double absBeatTime = 0;
+    double prevAbsBeatStart = 0.0;
+    double prevSpb = 60.0 / timeinfo.front().bpm;
+
+    for(auto const & tInfo : timeinfo) {
+        if(absBeat >= tInfo.absBeatStart) {
+            absBeatTime += prevSpb * (tInfo.absBeatStart - prevAbsBeatStart);
+
+            prevAbsBeatStart = tInfo.absBeatStart;
+            prevSpb = (60.0 / tInfo.bpm);
+        } else {
+            break;
+        }
+    }
+
+    // add the remainder
+    absBeatTime += prevSpb * (absBeat - prevAbsBeatStart);
+
+    return absBeatTime;
+}
+
+double calculateAbsBeat(double absTime, const std::vector<Timeinfo> & timeinfo) {
+    if(timeinfo.empty()) {
+        return 0.0;
+    }
+
+    const Timeinfo * currSection { &timeinfo.front() };
+    for(auto const & tInfo : timeinfo) {
+        if(absTime >= tInfo.absTimeStart) {
+            currSection = &tInfo;
+        } else {
+            break;
+        }
+    }
+
+    return currSection->absBeatStart + (absTime - currSection->absTimeStart) * (currSection->bpm / 60.0);
+}
+
 std::pair<int, double> splitSecsbyMin(double seconds) {
     double minutes = seconds / 60;
 
@@ -101,6 +138,10 @@ std::pair<int, double> splitSecsbyMin(double seconds) {
     return std::make_pair(fullMinutes, leftoverSecs);
 }
 
+size_t getStringMemoryUsage(const std::string & str) {
+    return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+}
+
 bool cmpSecond(const std::pair<std::string, int> & l, const std::pair<std::string, int> & r) {
     return l.second > r.second;
 }
@@ -1,6 +1,7 @@
 #include "editor.hpp"
 #include "config/init.hpp"
 #include "config/constants.hpp"
+#include "systems/profiler.hpp"
 #include "ui/ui.hpp"
 
 #include "IconsFontAwesome6.h"
@@ -20,6 +21,7 @@ Editor::Editor(SDL_Window * window, SDL_Renderer * renderer) : window(window), r
     initAudio();
 
     setWindowIcon();
+    TRACE_THREAD_NAME("UI");
     Preferences::Instance().loadFromFile(constants::PREFERENCES_PATH);
     editWindowManager.initLastDirPaths();
 }
@@ -49,7 +51,11 @@ void Editor::initKeys() {
 }
 
 void Editor::initAudio() {
-    audioSystem.initAudioSystem(window);
+    // without a usable sound device, keep editing with the mix rendered to nowhere
+    if(!audioSystem.initAudioSystem(window)) {
+        audioSystem.initAudioSystem(window, AudioSystem::Backend::Null);
+    }
+
     audioSystem.loadSound("keypress", constants::KEYPRESS_SOUND_PATH.string());
 }
 
@@ -63,6 +69,12 @@ void Editor::setWindowIcon() {
 void Editor::quit() {
     running = false;
 
+#ifdef TYPECHART_PROFILER
+    if(Tracer::Instance().isRecording()) {
+        Tracer::Instance().save(constants::TRACE_PATH);
+    }
+#endif
+
     audioSystem.quitAudioSystem();
 
     Preferences::Instance().saveToFile(constants::PREFERENCES_PATH);
@@ -78,14 +90,35 @@ void Editor::quit() {
 
 void Editor::loop() {
     handleEvents();
+
+    PROFILE_BEGIN_FRAME();
     update();
     render();
+    PROFILE_END_FRAME();
+}
+
+bool Editor::waitForEvent(SDL_Event & event) {
+    // nothing on screen changes by itself, so sleep until input, only waking periodically for background work
+    if(editWindowManager.isBusy()) {
+        return SDL_WaitEventTimeout(&event, constants::IDLE_REFRESH_MS) == 1;
+    }
+
+    return SDL_WaitEvent(&event) == 1;
+}
+
+bool Editor::isIdle() const {
+    // streaming music and a running playhead need update() every frame
+    return !audioSystem.isActive() && !editWindowManager.isPlaying() && SDL_TICKS_PASSED(SDL_GetTicks(), lastEventTicks + constants::IDLE_DELAY_MS);
 }
 
 void Editor::handleEvents() {
     if(running) {
         SDL_Event event;
-        while(SDL_PollEvent(&event)) {
+        bool waited { isIdle() && waitForEvent(event) };
+        while(waited || SDL_PollEvent(&event)) {
+            waited = false;
+            lastEventTicks = SDL_GetTicks();
+
             ImGui_ImplSDL2_ProcessEvent(&event);
             if(event.type == SDL_QUIT) {
                 running = false;
@@ -132,11 +165,14 @@ void Editor::update() {
         menubar::showMenuBar(menuFont, renderer, &audioSystem, editWindowManager);
         editWindowManager.showInitEditWindow(&audioSystem, renderer);
         editWindowManager.showOpenChartWindow(renderer, &audioSystem);
+        editWindowManager.uploadCoverArt(renderer);
         editWindowManager.showEditWindows(&audioSystem, keysPressed);
+        editWindowManager.showMemoryUsage(&audioSystem);
 
         updateShortcuts();
 
         Preferences::Instance().showPreferencesWindow(&audioSystem);
+        PROFILE_SHOW_OVERLAY();
     }
 }
 
@@ -168,6 +204,8 @@ void Editor::updateShortcuts() {
 
 void Editor::render() {
     if(running) {
+        PROFILE_SCOPE(RENDER);
+
         ImGui::Render();
         SDL_SetRenderDrawColor(renderer, constants::BG_R, constants::BG_G, constants::BG_B, constants::BG_A);
         SDL_RenderClear(renderer);
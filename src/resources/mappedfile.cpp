@@ -0,0 +1,102 @@
+#include "resources/mappedfile.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const fs::path & path) {
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+        CloseHandle(file);
+        return;
+    }
+
+    void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if(data) {
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const fs::path & path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return;
+    }
+
+    void * view = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if(view == MAP_FAILED) {
+        return;
+    }
+
+    // music is read front to back
+    madvise(view, static_cast<std::size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<std::size_t>(fileStat.st_size);
+}
+
+MappedFile::~MappedFile() {
+    if(data) {
+        munmap(const_cast<unsigned char *>(data), size);
+    }
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+    return data != nullptr;
+}
+
+const unsigned char * MappedFile::getData() const {
+    return data;
+}
+
+std::size_t MappedFile::getSize() const {
+    return size;
+}
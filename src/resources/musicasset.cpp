@@ -0,0 +1,348 @@
+#include "resources/musicasset.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include "systems/simd.hpp"
+#include "systems/tracer.hpp"
+
+namespace {
+    std::uint32_t readLE32(const unsigned char * bytes) {
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+            (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    bool isLittleEndianHost() {
+        std::uint16_t probe { 1 };
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        return firstByte == 1;
+    }
+
+    // locate the data chunk of a RIFF/WAVE file
+    bool findWavData(const unsigned char * data, std::size_t size, std::size_t & dataOffset, std::size_t & dataSize) {
+        if(size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        std::size_t offset { 12 };
+        while(offset + 8 <= size) {
+            std::size_t chunkSize { readLE32(data + offset + 4) };
+
+            if(std::memcmp(data + offset, "data", 4) == 0) {
+                // streamed files may leave the size unset, so trust the file length over it
+                dataOffset = offset + 8;
+                dataSize = std::min(chunkSize, size - dataOffset);
+                return true;
+            }
+
+            // chunks are padded to an even size
+            offset += 8 + chunkSize + (chunkSize & 1);
+        }
+
+        return false;
+    }
+}
+
+MusicAsset::MusicAsset(const fs::path & path) : path(path) {
+    sndfile = sf_open(path.string().c_str(), SFM_READ, &sfinfo);
+
+    if(sndfile && (sfinfo.frames < 1 || sfinfo.channels < 1 || sfinfo.samplerate < 1)) {
+        sf_close(sndfile);
+        sndfile = nullptr;
+    }
+
+    if(sndfile && mapPCM()) {
+        return;
+    }
+
+    if(sndfile && isCompressed(sfinfo)) {
+        auto numBlocks { static_cast<size_t>((sfinfo.frames + SEEK_INDEX_BLOCK_FRAMES - 1) / SEEK_INDEX_BLOCK_FRAMES) };
+        auto blockBytes { static_cast<size_t>(SEEK_INDEX_BLOCK_FRAMES * sfinfo.channels) * sizeof(short) };
+
+        // very long tracks keep seeking through the decoder past what fits
+        seekIndex.resize(std::min(numBlocks, MAX_SEEK_INDEX_BYTES / blockBytes));
+        indexThread = std::thread(&MusicAsset::buildSeekIndex, this);
+    }
+}
+
+MusicAsset::~MusicAsset() {
+    stopIndexing = true;
+    if(indexThread.joinable()) {
+        indexThread.join();
+    }
+
+    if(sndfile) {
+        sf_close(sndfile);
+    }
+}
+
+bool MusicAsset::isOpen() const {
+    return sndfile != nullptr;
+}
+
+const SF_INFO & MusicAsset::getInfo() const {
+    return sfinfo;
+}
+
+const fs::path & MusicAsset::getPath() const {
+    return path;
+}
+
+bool MusicAsset::isMapped() const {
+    return pcmData != nullptr;
+}
+
+bool MusicAsset::mapPCM() {
+    int majorFormat { sfinfo.format & SF_FORMAT_TYPEMASK };
+    int subformat { sfinfo.format & SF_FORMAT_SUBMASK };
+
+    if((majorFormat != SF_FORMAT_WAV && majorFormat != SF_FORMAT_WAVEX) || !isLittleEndianHost()) {
+        return false;
+    }
+
+    std::size_t sampleBytes;
+    switch(subformat) {
+        case SF_FORMAT_PCM_16:
+            sampleBytes = 2;
+            break;
+        case SF_FORMAT_PCM_32:
+        case SF_FORMAT_FLOAT:
+            sampleBytes = 4;
+            break;
+        default:
+            // 8/24-bit and compressed WAV subformats stay on the decoder
+            return false;
+    }
+
+    auto file { std::make_unique<MappedFile>(path) };
+    if(!file->isOpen()) {
+        return false;
+    }
+
+    std::size_t dataOffset;
+    std::size_t dataSize;
+    if(!findWavData(file->getData(), file->getSize(), dataOffset, dataSize)) {
+        return false;
+    }
+
+    // samples are read in place, so they must be aligned to their size
+    const unsigned char * data { file->getData() + dataOffset };
+    if(reinterpret_cast<std::uintptr_t>(data) % sampleBytes != 0) {
+        return false;
+    }
+
+    auto frameBytes { sampleBytes * static_cast<std::size_t>(sfinfo.channels) };
+    pcmFrames = std::min(sfinfo.frames, static_cast<sf_count_t>(dataSize / frameBytes));
+    pcmData = data;
+    pcmSubformat = subformat;
+    mappedFile = std::move(file);
+
+    return true;
+}
+
+const float * MusicAsset::getMappedFrames(sf_count_t startFrame, sf_count_t & numFrames) const {
+    if(!pcmData || pcmSubformat != SF_FORMAT_FLOAT || startFrame < 0 || startFrame >= pcmFrames) {
+        return nullptr;
+    }
+
+    numFrames = std::min(numFrames, pcmFrames - startFrame);
+    return reinterpret_cast<const float *>(pcmData) + startFrame * sfinfo.channels;
+}
+
+sf_count_t MusicAsset::readMappedFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames) const {
+    if(startFrame < 0 || startFrame >= pcmFrames) {
+        return 0;
+    }
+
+    numFrames = std::min(numFrames, pcmFrames - startFrame);
+    auto count { static_cast<std::size_t>(numFrames * sfinfo.channels) };
+    auto first { static_cast<std::size_t>(startFrame * sfinfo.channels) };
+
+    switch(pcmSubformat) {
+        case SF_FORMAT_PCM_16:
+            simd::int16ToFloat(samples, reinterpret_cast<const std::int16_t *>(pcmData) + first, count);
+            break;
+        case SF_FORMAT_PCM_32:
+            simd::int32ToFloat(samples, reinterpret_cast<const std::int32_t *>(pcmData) + first, count);
+            break;
+        default:
+            std::memcpy(samples, reinterpret_cast<const float *>(pcmData) + first, count * sizeof(float));
+            break;
+    }
+
+    return numFrames;
+}
+
+bool MusicAsset::hasSeekIndex() const {
+    return !seekIndex.empty();
+}
+
+float MusicAsset::getSeekIndexProgress() const {
+    return seekIndex.empty() ? 0.f : static_cast<float>(indexedBlocks) / static_cast<float>(seekIndex.size());
+}
+
+size_t MusicAsset::getMemoryUsage() const {
+    size_t bytes { seekIndex.capacity() * sizeof(std::vector<short>) };
+
+    // blocks past indexedBlocks may still be written by the indexing thread
+    size_t numIndexed { indexedBlocks.load(std::memory_order_acquire) };
+    for(size_t block = 0; block < numIndexed; block++) {
+        bytes += seekIndex[block].capacity() * sizeof(short);
+    }
+
+    return bytes;
+}
+
+bool MusicAsset::isCompressed(const SF_INFO & sfinfo) {
+    // these decoders can only seek by decoding forward from a sync point, or from the start
+    switch(sfinfo.format & SF_FORMAT_TYPEMASK) {
+        case SF_FORMAT_OGG:
+        case SF_FORMAT_MPEG:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void MusicAsset::buildSeekIndex() {
+    TRACE_THREAD_NAME("Seek index");
+    TRACE_SCOPE("Build seek index");
+
+    // a decoder of its own, so indexing never moves the playback decoder
+    SF_INFO indexInfo {};
+    SNDFILE * indexFile = sf_open(path.string().c_str(), SFM_READ, &indexInfo);
+    if(!indexFile) {
+        return;
+    }
+
+    // the decoders produce floats; overs on hot masters must saturate, as the float path used until indexing finishes does
+    sf_command(indexFile, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+
+    for(size_t block = 0; block < seekIndex.size() && !stopIndexing; block++) {
+        std::vector<short> samples(static_cast<size_t>(SEEK_INDEX_BLOCK_FRAMES * indexInfo.channels));
+
+        sf_count_t framesRead = sf_readf_short(indexFile, samples.data(), SEEK_INDEX_BLOCK_FRAMES);
+        if(framesRead <= 0) {
+            break;
+        }
+
+        samples.resize(static_cast<size_t>(framesRead * indexInfo.channels));
+        seekIndex[block] = std::move(samples);
+        indexedBlocks.store(block + 1, std::memory_order_release);
+
+        if(framesRead < SEEK_INDEX_BLOCK_FRAMES) {
+            break;
+        }
+    }
+
+    sf_close(indexFile);
+}
+
+sf_count_t MusicAsset::readIndexedFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames) const {
+    size_t numIndexed { indexedBlocks.load(std::memory_order_acquire) };
+    sf_count_t framesRead { 0 };
+
+    while(framesRead < numFrames) {
+        sf_count_t frame { startFrame + framesRead };
+        auto block { static_cast<size_t>(frame / SEEK_INDEX_BLOCK_FRAMES) };
+        if(block >= numIndexed) {
+            break;
+        }
+
+        const auto & blockSamples { seekIndex[block] };
+        sf_count_t blockFrames { static_cast<sf_count_t>(blockSamples.size()) / sfinfo.channels };
+        sf_count_t offset { frame - static_cast<sf_count_t>(block) * SEEK_INDEX_BLOCK_FRAMES };
+        if(offset >= blockFrames) {
+            break;
+        }
+
+        sf_count_t count { std::min(numFrames - framesRead, blockFrames - offset) };
+        const short * src { blockSamples.data() + offset * sfinfo.channels };
+        float * dst { samples + framesRead * sfinfo.channels };
+
+        // same scaling sf_readf_float uses for 16-bit data
+        for(sf_count_t i = 0; i < count * sfinfo.channels; i++) {
+            dst[i] = static_cast<float>(src[i]) / 32768.f;
+        }
+
+        framesRead += count;
+    }
+
+    return framesRead;
+}
+
+sf_count_t MusicAsset::readFrames(sf_count_t startFrame, float * samples, sf_count_t numFrames) {
+    if(!sndfile) {
+        return 0;
+    }
+
+    if(pcmData) {
+        return readMappedFrames(startFrame, samples, numFrames);
+    }
+
+    sf_count_t indexedFrames { 0 };
+    if(!seekIndex.empty()) {
+        indexedFrames = readIndexedFrames(startFrame, samples, numFrames);
+        if(indexedFrames == numFrames) {
+            return indexedFrames;
+        }
+
+        // the rest comes from the decoder
+        startFrame += indexedFrames;
+        samples += indexedFrames * sfinfo.channels;
+        numFrames -= indexedFrames;
+    }
+
+    if(startFrame != decoderFrame) {
+        decoderFrame = sf_seek(sndfile, startFrame, SEEK_SET);
+        if(decoderFrame != startFrame) {
+            // the decoder position is unknown now, so the next read seeks again
+            decoderFrame = -1;
+            return indexedFrames;
+        }
+    }
+
+    sf_count_t framesRead = sf_readf_float(sndfile, samples, numFrames);
+    decoderFrame += framesRead;
+
+    return indexedFrames + framesRead;
+}
+
+std::shared_ptr<MusicAsset> MusicAssetCache::acquire(const fs::path & path) {
+    std::error_code ec;
+    auto canonicalPath { fs::canonical(path, ec) };
+    if(ec) {
+        return nullptr;
+    }
+
+    auto lastWrite { fs::last_write_time(canonicalPath, ec) };
+    if(ec) {
+        return nullptr;
+    }
+
+    // a rewritten file gets a new entry; sources still holding the old asset keep it alive
+    std::string key { canonicalPath.string() + "|" + std::to_string(lastWrite.time_since_epoch().count()) };
+
+    auto assetIter { assets.find(key) };
+    if(assetIter != assets.end()) {
+        if(auto asset = assetIter->second.lock()) {
+            return asset;
+        }
+    }
+
+    auto asset { std::make_shared<MusicAsset>(canonicalPath) };
+    if(!asset->isOpen()) {
+        return nullptr;
+    }
+
+    // drop entries whose assets were released
+    for(auto iter = assets.begin(); iter != assets.end();) {
+        iter = iter->second.expired() ? assets.erase(iter) : std::next(iter);
+    }
+
+    assets[key] = asset;
+    return asset;
+}
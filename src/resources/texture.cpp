@@ -1,24 +1,98 @@
 #include "resources/texture.hpp"
 
+#include <algorithm>
 #include <string>
 #include <SDL2/SDL_image.h>
 
+namespace {
+    // averages every source pixel covered by each destination pixel, both surfaces RGBA32
+    void boxFilter(const SDL_Surface * src, SDL_Surface * dst) {
+        const auto * srcPixels { static_cast<const Uint8 *>(src->pixels) };
+        auto * dstPixels { static_cast<Uint8 *>(dst->pixels) };
+
+        for(int y = 0; y < dst->h; y++) {
+            int srcY0 { y * src->h / dst->h };
+            int srcY1 { std::max(srcY0 + 1, (y + 1) * src->h / dst->h) };
+
+            for(int x = 0; x < dst->w; x++) {
+                int srcX0 { x * src->w / dst->w };
+                int srcX1 { std::max(srcX0 + 1, (x + 1) * src->w / dst->w) };
+
+                Uint32 sums[4] { 0, 0, 0, 0 };
+                for(int sy = srcY0; sy < srcY1; sy++) {
+                    const Uint8 * row { srcPixels + sy * src->pitch };
+                    for(int sx = srcX0; sx < srcX1; sx++) {
+                        for(int c = 0; c < 4; c++) {
+                            sums[c] += row[sx * 4 + c];
+                        }
+                    }
+                }
+
+                auto count { static_cast<Uint32>((srcY1 - srcY0) * (srcX1 - srcX0)) };
+                Uint8 * pixel { dstPixels + y * dst->pitch + x * 4 };
+                for(int c = 0; c < 4; c++) {
+                    pixel[c] = static_cast<Uint8>(sums[c] / count);
+                }
+            }
+        }
+    }
+}
+
 namespace Texture {
-    std::shared_ptr<SDL_Texture> loadTexture(const fs::path & path, SDL_Renderer * renderer) {
+    SDL_Surface * loadSurface(const fs::path & path, int maxSize) {
         SDL_Surface * surface = IMG_Load(path.string().c_str());
         if(!surface) {
             return nullptr;
         }
 
-        // Create SDL texture from the surface
-        std::shared_ptr<SDL_Texture> newTexture (SDL_CreateTextureFromSurface(renderer, surface), SDL_DestroyTexture);
-            
-        if(!newTexture.get()) {
+        int largestSide { std::max(surface->w, surface->h) };
+        if(largestSide <= maxSize) {
+            return surface;
+        }
+
+        SDL_Surface * converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+        if(!converted) {
+            return surface;
+        }
+
+        SDL_FreeSurface(surface);
+
+        int width { std::max(1, converted->w * maxSize / largestSide) };
+        int height { std::max(1, converted->h * maxSize / largestSide) };
+
+        SDL_Surface * scaled = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        if(!scaled) {
+            return converted;
+        }
+
+        boxFilter(converted, scaled);
+        SDL_FreeSurface(converted);
+
+        return scaled;
+    }
+
+    std::shared_ptr<SDL_Texture> createTexture(SDL_Surface * surface, SDL_Renderer * renderer) {
+        if(!surface) {
             return nullptr;
         }
 
+        std::shared_ptr<SDL_Texture> newTexture { SDL_CreateTextureFromSurface(renderer, surface), SDL_DestroyTexture };
         SDL_FreeSurface(surface);
 
+        if(!newTexture.get()) {
+            return nullptr;
+        }
+
         return newTexture;
     }
+
+    size_t getMemoryUsage(SDL_Texture * texture) {
+        Uint32 format;
+        int width, height;
+        if(!texture || SDL_QueryTexture(texture, &format, nullptr, &width, &height) != 0) {
+            return 0;
+        }
+
+        return static_cast<size_t>(width) * static_cast<size_t>(height) * SDL_BYTESPERPIXEL(format);
+    }
 }
@@ -0,0 +1,106 @@
+#include "resources/texturecache.hpp"
+
+#include "resources/texture.hpp"
+#include "systems/tracer.hpp"
+
+TextureCache::TextureCache(int maxSize) : maxSize(maxSize) {}
+
+TextureCache::~TextureCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopDecoding = true;
+    }
+
+    requestReady.notify_one();
+    if(decodeThread.joinable()) {
+        decodeThread.join();
+    }
+
+    for(const auto & image : decoded) {
+        SDL_FreeSurface(image.surface);
+    }
+}
+
+std::shared_ptr<TextureCache::Entry> TextureCache::load(const fs::path & path) {
+    if(auto entry { entries[path].lock() }) {
+        return entry;
+    }
+
+    // forget files no window shows anymore
+    for(auto it = entries.begin(); it != entries.end();) {
+        it = it->second.expired() && it->first != path ? entries.erase(it) : std::next(it);
+    }
+
+    auto entry { std::make_shared<Entry>() };
+    entries[path] = entry;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ path, entry });
+        pendingImages++;
+    }
+
+    if(!decodeThread.joinable()) {
+        decodeThread = std::thread(&TextureCache::decodeImages, this);
+    }
+
+    requestReady.notify_one();
+
+    return entry;
+}
+
+void TextureCache::upload(SDL_Renderer * renderer) {
+    std::vector<Decoded> images;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        images.swap(decoded);
+    }
+
+    for(const auto & image : images) {
+        if(auto entry { image.entry.lock() }) {
+            entry->texture = Texture::createTexture(image.surface, renderer);
+        } else {
+            SDL_FreeSurface(image.surface);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingImages -= images.size();
+}
+
+bool TextureCache::isLoading() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingImages > 0;
+}
+
+void TextureCache::decodeImages() {
+    TRACE_THREAD_NAME("Cover art");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        requestReady.wait(lock, [this] { return stopDecoding || !requests.empty(); });
+        if(stopDecoding) {
+            return;
+        }
+
+        Request request { requests.front() };
+        requests.pop_front();
+
+        // the window may have closed while the request was queued
+        if(request.entry.expired()) {
+            pendingImages--;
+            continue;
+        }
+
+        lock.unlock();
+
+        SDL_Surface * surface { nullptr };
+        {
+            TRACE_SCOPE("Decode cover art");
+            surface = Texture::loadSurface(request.path, maxSize);
+        }
+
+        lock.lock();
+        decoded.push_back({ request.entry, surface });
+    }
+}
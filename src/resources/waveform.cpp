@@ -0,0 +1,334 @@
+#include "resources/waveform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <float.h>
+#include <fstream>
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "imgui_internal.h"
+
+#include "config/constants.hpp"
+#include "config/utils.hpp"
+#include "systems/simd.hpp"
+#include "systems/tracer.hpp"
+
+namespace {
+    constexpr char CACHE_MAGIC[4] { 'T', 'C', 'P', 'K' };
+    constexpr std::uint32_t CACHE_VERSION { 1 };
+
+    // identifies the music file + decode settings a cache was written for
+    struct CacheHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t musicFileSize;
+        std::int64_t musicWriteTime;
+        std::int32_t sampleRate;
+        std::int32_t channels;
+        std::int64_t totalFrames;
+        std::int64_t bucketFrames;
+        std::uint64_t numPeaks;
+    };
+
+    bool getMusicFileStamp(const fs::path & musicPath, std::uint64_t & fileSize, std::int64_t & writeTime) {
+        std::error_code ec;
+        fileSize = fs::file_size(musicPath, ec);
+        if(ec) {
+            return false;
+        }
+
+        auto lastWrite { fs::last_write_time(musicPath, ec) };
+        if(ec) {
+            return false;
+        }
+
+        writeTime = static_cast<std::int64_t>(lastWrite.time_since_epoch().count());
+        return true;
+    }
+}
+
+Waveform::Waveform(const fs::path & musicPath)
+    : musicPath(musicPath)
+    , cachePath(fs::path(musicPath).concat(constants::WAVEFORM_CACHE_EXTENSION)) {}
+
+Waveform::~Waveform() {
+    stopBuilding = true;
+    if(buildThread.joinable()) {
+        buildThread.join();
+    }
+}
+
+bool Waveform::build() {
+    if(buildThread.joinable()) {
+        return false;
+    }
+
+    SF_INFO sfinfo {};
+    SNDFILE * sndfile = sf_open(musicPath.string().c_str(), SFM_READ, &sfinfo);
+    if(!sndfile) {
+        return false;
+    }
+
+    if(sfinfo.frames <= 0 || sfinfo.channels <= 0 || sfinfo.samplerate <= 0) {
+        sf_close(sndfile);
+        return false;
+    }
+
+    sampleRate = sfinfo.samplerate;
+    channels = sfinfo.channels;
+    totalFrames = sfinfo.frames;
+
+    // size every level up front so the UI thread can read while the worker fills them in
+    auto numBuckets { static_cast<size_t>((totalFrames + BASE_BUCKET_FRAMES - 1) / BASE_BUCKET_FRAMES) };
+    while(true) {
+        levels.emplace_back(numBuckets, Peak{ 0.f, 0.f });
+        if(numBuckets <= 1) {
+            break;
+        }
+
+        numBuckets = (numBuckets + 1) / 2;
+    }
+
+    levelsBuilt.assign(levels.size(), 0);
+
+    buildThread = std::thread(&Waveform::buildPeaks, this, sndfile);
+    return true;
+}
+
+bool Waveform::isFinished() const {
+    return finished.load(std::memory_order_acquire);
+}
+
+void Waveform::buildPeaks(SNDFILE * sndfile) {
+    TRACE_THREAD_NAME("Waveform");
+    TRACE_SCOPE("Build waveform");
+
+    if(loadCache()) {
+        sf_close(sndfile);
+        return;
+    }
+
+    std::vector<float> chunk(static_cast<size_t>(DECODE_CHUNK_FRAMES * channels));
+    auto & basePeaks { levels.front() };
+
+    sf_count_t framesRead { 0 };
+    while(!stopBuilding && framesRead < totalFrames) {
+        sf_count_t framesToRead { std::min(DECODE_CHUNK_FRAMES, totalFrames - framesRead) };
+        sf_count_t readCount { sf_readf_float(sndfile, chunk.data(), framesToRead) };
+        if(readCount <= 0) {
+            break;
+        }
+
+        for(sf_count_t bucketStart = 0; bucketStart < readCount; bucketStart += BASE_BUCKET_FRAMES) {
+            sf_count_t bucketFrames { std::min(BASE_BUCKET_FRAMES, readCount - bucketStart) };
+
+            Peak peak { FLT_MAX, -FLT_MAX };
+            simd::minMax(chunk.data() + bucketStart * channels, static_cast<size_t>(bucketFrames * channels), peak.min, peak.max);
+            basePeaks[static_cast<size_t>((framesRead + bucketStart) / BASE_BUCKET_FRAMES)] = peak;
+        }
+
+        framesRead += readCount;
+
+        // a short read means the decoder reached the end early (frame counts can be estimates)
+        if(readCount < framesToRead) {
+            break;
+        }
+
+        levelsBuilt.front() = static_cast<size_t>(framesRead / BASE_BUCKET_FRAMES);
+        buildLevels(false);
+        framesReady.store(framesRead, std::memory_order_release);
+    }
+
+    // a decode error also ends reading early, but unlike an estimated length its peaks mustn't outlive the session
+    bool decodeFailed { sf_error(sndfile) != SF_ERR_NO_ERROR };
+    sf_close(sndfile);
+
+    if(!stopBuilding) {
+        buildLevels(true);
+        framesReady.store(totalFrames, std::memory_order_release);
+        finished.store(true, std::memory_order_release);
+
+        if(!decodeFailed) {
+            saveCache();
+        }
+    }
+}
+
+void Waveform::buildLevels(bool complete) {
+    if(complete) {
+        levelsBuilt.front() = levels.front().size();
+    }
+
+    for(size_t level = 1; level < levels.size(); level++) {
+        const auto & children { levels.at(level - 1) };
+        auto & peaks { levels.at(level) };
+
+        size_t buildLimit { complete ? peaks.size() : levelsBuilt.at(level - 1) / 2 };
+        for(size_t i = levelsBuilt.at(level); i < buildLimit; i++) {
+            Peak peak { children.at(i * 2) };
+            if(i * 2 + 1 < children.size()) {
+                peak.min = std::min(peak.min, children.at(i * 2 + 1).min);
+                peak.max = std::max(peak.max, children.at(i * 2 + 1).max);
+            }
+
+            peaks[i] = peak;
+        }
+
+        levelsBuilt.at(level) = std::max(levelsBuilt.at(level), buildLimit);
+    }
+}
+
+bool Waveform::loadCache() {
+    std::uint64_t fileSize { 0 };
+    std::int64_t writeTime { 0 };
+    if(!getMusicFileStamp(musicPath, fileSize, writeTime)) {
+        return false;
+    }
+
+    std::ifstream in(cachePath, std::ios::binary);
+    if(!in) {
+        return false;
+    }
+
+    CacheHeader header;
+    if(!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+
+    auto & basePeaks { levels.front() };
+    bool valid { std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+        header.version == CACHE_VERSION && header.musicFileSize == fileSize && header.musicWriteTime == writeTime &&
+        header.sampleRate == sampleRate && header.channels == channels && header.totalFrames == totalFrames &&
+        header.bucketFrames == BASE_BUCKET_FRAMES && header.numPeaks == basePeaks.size() };
+
+    if(!valid || !in.read(reinterpret_cast<char *>(basePeaks.data()), static_cast<std::streamsize>(basePeaks.size() * sizeof(Peak)))) {
+        return false;
+    }
+
+    buildLevels(true);
+    framesReady.store(totalFrames, std::memory_order_release);
+    finished.store(true, std::memory_order_release);
+
+    return true;
+}
+
+void Waveform::saveCache() const {
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.sampleRate = sampleRate;
+    header.channels = channels;
+    header.totalFrames = totalFrames;
+    header.bucketFrames = BASE_BUCKET_FRAMES;
+    header.numPeaks = levels.front().size();
+
+    if(!getMusicFileStamp(musicPath, header.musicFileSize, header.musicWriteTime)) {
+        return;
+    }
+
+    // the cache is only an optimization, so a read-only song directory is not an error
+    std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+    if(out) {
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(levels.front().data()), static_cast<std::streamsize>(levels.front().size() * sizeof(Peak)));
+    }
+}
+
+size_t Waveform::getMemoryUsage() const {
+    // the levels are allocated before building starts, so their sizes are safe to read
+    size_t bytes { levelsBuilt.capacity() * sizeof(size_t) };
+    for(const auto & peaks : levels) {
+        bytes += sizeof(peaks) + peaks.capacity() * sizeof(Peak);
+    }
+
+    return bytes;
+}
+
+size_t Waveform::getReadyBuckets(size_t level) const {
+    if(finished.load(std::memory_order_acquire)) {
+        return levels.at(level).size();
+    }
+
+    return static_cast<size_t>(framesReady.load(std::memory_order_acquire) / (BASE_BUCKET_FRAMES << level));
+}
+
+bool Waveform::getPeak(sf_count_t startFrame, sf_count_t endFrame, Peak & peak) const {
+    startFrame = std::max(startFrame, static_cast<sf_count_t>(0));
+    endFrame = std::min(std::max(endFrame, startFrame + 1), totalFrames);
+    if(startFrame >= endFrame) {
+        return false;
+    }
+
+    // coarsest level whose buckets still fit inside the requested span
+    size_t level { 0 };
+    sf_count_t span { endFrame - startFrame };
+    while(level + 1 < levels.size() && (BASE_BUCKET_FRAMES << (level + 1)) <= span) {
+        level++;
+    }
+
+    sf_count_t bucketFrames { BASE_BUCKET_FRAMES << level };
+    auto firstBucket { static_cast<size_t>(startFrame / bucketFrames) };
+    auto lastBucket { static_cast<size_t>((endFrame - 1) / bucketFrames) };
+
+    size_t readyBuckets { getReadyBuckets(level) };
+    if(firstBucket >= readyBuckets) {
+        return false;
+    }
+
+    lastBucket = std::min(lastBucket, readyBuckets - 1);
+
+    const auto & peaks { levels.at(level) };
+    peak = peaks[firstBucket];
+    for(size_t i = firstBucket + 1; i <= lastBucket; i++) {
+        peak.min = std::min(peak.min, peaks[i].min);
+        peak.max = std::max(peak.max, peaks[i].max);
+    }
+
+    return true;
+}
+
+void Waveform::draw(ImDrawList * drawList, const ImRect & rc, double firstBeat, float pixelsPerBeat,
+    const std::vector<Timeinfo> & timeinfo, int offsetMS, ImU32 color) const {
+    if(levels.empty() || timeinfo.empty() || pixelsPerBeat <= 0.f) {
+        return;
+    }
+
+    auto columns { static_cast<int>(std::ceil(rc.GetWidth())) };
+    if(columns <= 0) {
+        return;
+    }
+
+    float centerY { (rc.Min.y + rc.Max.y) / 2.f };
+    float halfHeight { rc.GetHeight() * 0.45f };
+    double offsetSecs { offsetMS / 1000.0 };
+    double columnBeats { 1.0 / pixelsPerBeat };
+
+    // one rect per pixel column, reserved as a single batch
+    drawList->PrimReserve(columns * 6, columns * 4);
+    int drawnColumns { 0 };
+
+    double columnStartTime { utils::calculateAbsTime(firstBeat, timeinfo) + offsetSecs };
+    for(int i = 0; i < columns; i++) {
+        double columnEndTime { utils::calculateAbsTime(firstBeat + (i + 1) * columnBeats, timeinfo) + offsetSecs };
+
+        auto startFrame { static_cast<sf_count_t>(columnStartTime * sampleRate) };
+        auto endFrame { static_cast<sf_count_t>(columnEndTime * sampleRate) };
+        columnStartTime = columnEndTime;
+
+        Peak peak;
+        if(!getPeak(startFrame, endFrame, peak)) {
+            continue;
+        }
+
+        float top { centerY - std::clamp(peak.max, -1.f, 1.f) * halfHeight };
+        float bottom { centerY - std::clamp(peak.min, -1.f, 1.f) * halfHeight };
+        float x { rc.Min.x + i };
+
+        drawList->PrimRect(ImVec2(x, top), ImVec2(x + 1.f, std::max(bottom, top + 1.f)), color);
+        drawnColumns++;
+    }
+
+    drawList->PrimUnreserve((columns - drawnColumns) * 6, (columns - drawnColumns) * 4);
+}
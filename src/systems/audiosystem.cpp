@@ -1,27 +1,152 @@
+#include <algorithm>
+#include <cmath>
 #include <limits.h>
 #include <stdio.h>
 
 #include <SDL2/SDL.h>
 
 #include "systems/audiosystem.hpp"
+#include "systems/profiler.hpp"
+#include "systems/simd.hpp"
+#include "systems/tracer.hpp"
+
+namespace {
+    constexpr double PI { 3.14159265358979323846 };
+
+    // linear resample and channel conversion of a (short) decoded sound to another format
+    std::vector<float> convertSound(const std::vector<float> & samples, int channels, int samplerate, int targetChannels, int targetSamplerate) {
+        if(channels < 1 || samplerate < 1 || targetChannels < 1 || targetSamplerate < 1) {
+            return {};
+        }
+
+        auto numFrames { static_cast<sf_count_t>(samples.size() / channels) };
+        if(numFrames < 1) {
+            return {};
+        }
+
+        double step { static_cast<double>(samplerate) / targetSamplerate };
+        auto numTargetFrames { static_cast<sf_count_t>((numFrames - 1) / step) + 1 };
+
+        // mono is spread over all channels, and mixed down when the target is mono
+        auto sampleAt = [&](sf_count_t frame, int channel) {
+            const float * frameSamples { &samples[frame * channels] };
+            if(targetChannels == 1 && channels > 1) {
+                float sum { 0.f };
+                for(int c = 0; c < channels; c++) {
+                    sum += frameSamples[c];
+                }
+
+                return sum / channels;
+            }
+
+            return frameSamples[std::min(channel, channels - 1)];
+        };
+
+        std::vector<float> converted(numTargetFrames * targetChannels);
+        for(sf_count_t frame = 0; frame < numTargetFrames; frame++) {
+            double position { frame * step };
+            auto frame0 { std::min(static_cast<sf_count_t>(position), numFrames - 1) };
+            auto frame1 { std::min(frame0 + 1, numFrames - 1) };
+            auto frac { static_cast<float>(position - frame0) };
+
+            for(int c = 0; c < targetChannels; c++) {
+                float sample0 { sampleAt(frame0, c) };
+                converted[frame * targetChannels + c] = sample0 + frac * (sampleAt(frame1, c) - sample0);
+            }
+        }
+
+        return converted;
+    }
+
+    // a short decaying sine burst, for metronome clicks
+    std::vector<float> makeClick(double frequency, float amplitude, double duration, int channels, int samplerate) {
+        auto numFrames { static_cast<size_t>(duration * samplerate) };
+        std::vector<float> click(numFrames * channels);
+
+        for(size_t i = 0; i < numFrames; i++) {
+            double t { static_cast<double>(i) / samplerate };
+            auto sample { static_cast<float>(amplitude * std::sin(2.0 * PI * frequency * t) * std::exp(-t / (duration / 5.0))) };
+            std::fill_n(click.begin() + i * channels, channels, sample);
+        }
+
+        return click;
+    }
+
+    // stereo downmix weights for the default WAVE channel orders: left row, then right row.
+    // centre channels go to both sides at -3 dB, LFE is dropped, and each row is normalized so
+    // a full scale input can't clip
+    std::vector<float> getDownmixWeights(int channels) {
+        constexpr float CENTER { 0.70710678f };
+
+        // L/R front or surround, C centre (front or back), F low frequency
+        std::string_view layout;
+        switch(channels) {
+            case 3: layout = "LRC"; break;
+            case 4: layout = "LRLR"; break;
+            case 5: layout = "LRCLR"; break;
+            case 6: layout = "LRCFLR"; break;
+            case 7: layout = "LRCFCLR"; break;
+            case 8: layout = "LRCFLRLR"; break;
+            default: break;
+        }
+
+        std::vector<float> weights(channels * 2, 0.f);
+        for(int c = 0; c < channels; c++) {
+            // unknown layouts alternate sides
+            char role { c < static_cast<int>(layout.size()) ? layout[c] : (c % 2 == 0 ? 'L' : 'R') };
+
+            weights[c] = role == 'L' ? 1.f : (role == 'C' ? CENTER : 0.f);
+            weights[channels + c] = role == 'R' ? 1.f : (role == 'C' ? CENTER : 0.f);
+        }
+
+        for(int side = 0; side < 2; side++) {
+            float sum { 0.f };
+            for(int c = 0; c < channels; c++) {
+                sum += weights[side * channels + c];
+            }
+
+            for(int c = 0; c < channels && sum > 0.f; c++) {
+                weights[side * channels + c] /= sum;
+            }
+        }
+
+        return weights;
+    }
+}
+
+bool AudioSystem::initAudioSystem(SDL_Window * window, Backend backend) {
+    this->backend = backend;
 
-void AudioSystem::initAudioSystem(SDL_Window * window) {
     // Initialize sound device
-    soundDevice = alcOpenDevice(nullptr);
-    if(!soundDevice) {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Audio system initialization failure", "Failed to load sound device", window);
-        return;
+    if(backend == Backend::Device) {
+        soundDevice = alcOpenDevice(nullptr);
+        if(!soundDevice) {
+            reportError(window, "Audio system initialization failure", "Failed to load sound device");
+            return false;
+        }
+
+        soundContext = alcCreateContext(soundDevice, nullptr);
+    } else if(!openLoopbackDevice()) {
+        reportError(window, "Audio system initialization failure", "Loopback rendering (ALC_SOFT_loopback) is not supported");
+        return false;
     }
 
-    soundContext = alcCreateContext(soundDevice, nullptr);
     if(!soundContext) {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Audio system initialization failure", "Failed to get sound context", window);
-        return;
+        reportError(window, "Audio system initialization failure", "Failed to get sound context");
+
+        alcCloseDevice(soundDevice);
+        soundDevice = nullptr;
+        return false;
     }
 
     if(!alcMakeContextCurrent(soundContext)) {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Audio system initialization failure", "Failed to set current context", window);
-        return;
+        reportError(window, "Audio system initialization failure", "Failed to set current context");
+
+        alcDestroyContext(soundContext);
+        alcCloseDevice(soundDevice);
+        soundContext = nullptr;
+        soundDevice = nullptr;
+        return false;
     }
 
     // Get name of the device we just loaded
@@ -36,6 +161,10 @@ void AudioSystem::initAudioSystem(SDL_Window * window) {
 
     printf("Using sound device %s\n", deviceName);
 
+    ALCint frequency { 0 };
+    alcGetIntegerv(soundDevice, ALC_FREQUENCY, 1, &frequency);
+    deviceFrequency = frequency > 0 ? frequency : LOOPBACK_FREQUENCY;
+
     // setup listener position, velocity
     alListener3f(AL_POSITION, 0, 0, 1.f);
     alListener3f(AL_VELOCITY, 0, 0, 0);
@@ -52,6 +181,8 @@ void AudioSystem::initAudioSystem(SDL_Window * window) {
         soundBuffers[i] = 0;
     }
 
+    nextSoundSource = 0;
+
     // Setup music sources
     for(int i = 0; i < NUM_MUSIC_SOURCES; i++) {
         alGenSources(1, &musicSources[i]);
@@ -61,15 +192,97 @@ void AudioSystem::initAudioSystem(SDL_Window * window) {
         stopMusicsEarly[i] = false;
         musicStops[i] = 0.f;
         lastBufferPositions[i] = 0.f;
+        streamFramePositions[i] = 0.0;
+        playbackRates[i] = 1.0;
         sfInfos[i] = SF_INFO{};
 
         musicSourcesActive.try_emplace(i, false);
     }
 
     for(int i = 0; i < NUM_MUSIC_SOURCES; i++) {
-        sndfiles[i] = nullptr;
+        decodeFramePositions[i] = 0;
         membufs[i] = nullptr;
     }
+
+    alGenSources(1, &scrubSource);
+    alGenBuffers(NUM_SCRUB_BUFFERS, &scrubBuffers[0]);
+    initSoundSource(scrubSource, 1.f, 1.f, {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, false);
+    freeScrubBuffers.assign(scrubBuffers.begin(), scrubBuffers.end());
+
+    lastRenderCounter = SDL_GetPerformanceCounter();
+
+    return true;
+}
+
+bool AudioSystem::openLoopbackDevice() {
+#ifdef __APPLE__
+    return false;
+#else
+    if(!alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback")) {
+        return false;
+    }
+
+    auto loopbackOpenDevice { reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT")) };
+    auto isRenderFormatSupported { reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(alcGetProcAddress(nullptr, "alcIsRenderFormatSupportedSOFT")) };
+    renderSamples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+
+    if(!loopbackOpenDevice || !isRenderFormatSupported || !renderSamples) {
+        return false;
+    }
+
+    soundDevice = loopbackOpenDevice(nullptr);
+    if(!soundDevice) {
+        return false;
+    }
+
+    if(!isRenderFormatSupported(soundDevice, LOOPBACK_FREQUENCY, ALC_STEREO_SOFT, ALC_FLOAT_SOFT)) {
+        alcCloseDevice(soundDevice);
+        soundDevice = nullptr;
+        return false;
+    }
+
+    std::array<ALCint, 7> attributes {
+        ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+        ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT,
+        ALC_FREQUENCY, LOOPBACK_FREQUENCY,
+        0
+    };
+
+    soundContext = alcCreateContext(soundDevice, &attributes[0]);
+    return true;
+#endif
+}
+
+int AudioSystem::renderAudio(float * samples, int numFrames) {
+#ifdef __APPLE__
+    return 0;
+#else
+    if(backend == Backend::Device || !renderSamples || numFrames < 1) {
+        return 0;
+    }
+
+    // the null sink renders into scratch space that is thrown away
+    if(!samples) {
+        renderScratch.resize(static_cast<size_t>(RENDER_CHUNK_FRAMES) * LOOPBACK_CHANNELS);
+
+        for(int rendered = 0; rendered < numFrames; rendered += RENDER_CHUNK_FRAMES) {
+            renderSamples(soundDevice, renderScratch.data(), std::min(RENDER_CHUNK_FRAMES, numFrames - rendered));
+        }
+    } else {
+        renderSamples(soundDevice, samples, numFrames);
+    }
+
+    return numFrames;
+#endif
+}
+
+void AudioSystem::reportError(SDL_Window * window, const char * title, const char * message) const {
+    // headless backends have nobody to show a message box to
+    if(backend == Backend::Device) {
+        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, title, message, window);
+    } else {
+        fprintf(stderr, "%s: %s\n", title, message);
+    }
 }
 
 void AudioSystem::initSoundSource(ALuint source, float pitch, float gain, std::array<float, 3> position, std::array<float, 3> velocity, bool looping) const {
@@ -90,10 +303,7 @@ void AudioSystem::quitAudioSystem() {
         alSourceStop(musicSources[i]);
         alSourcei(musicSources[i], AL_BUFFER, 0);
 
-        if(sndfiles[i]) {
-            sf_close(sndfiles[i]);
-            sndfiles[i] = nullptr;
-        }
+        musicAssets[i].reset();
 
         if(membufs[i]) {
             free(membufs[i]);
@@ -102,12 +312,19 @@ void AudioSystem::quitAudioSystem() {
     }
     
     alDeleteSources(NUM_SOUND_SOURCES, &soundSources[0]);
-    for(const auto & [soundID, soundBuffer] : soundBufferIDs) {
-        if(soundBuffer && alIsBuffer(soundBuffer)) {
-            alDeleteBuffers(1, &soundBuffer);
+    for(const auto & sound : loadedSounds) {
+        if(sound.buffer && alIsBuffer(sound.buffer)) {
+            alDeleteBuffers(1, &sound.buffer);
         }
     }
 
+    loadedSounds.clear();
+    soundHandles.clear();
+
+    stopScrub();
+    alDeleteSources(1, &scrubSource);
+    alDeleteBuffers(NUM_SCRUB_BUFFERS, &scrubBuffers[0]);
+
     alDeleteSources(NUM_MUSIC_SOURCES, &musicSources[0]);
 
     for(int i = 0; i < NUM_MUSIC_SOURCES; i++)
@@ -128,6 +345,22 @@ void AudioSystem::quitAudioSystem() {
 }
 
 void AudioSystem::update(SDL_Window * window) {
+    PROFILE_SCOPE(AUDIO_UPDATE);
+
+    // the null sink consumes audio in real time, as a device would
+    if(backend == Backend::Null) {
+        Uint64 now { SDL_GetPerformanceCounter() };
+        Uint64 frequency { SDL_GetPerformanceFrequency() };
+
+        auto numFrames { static_cast<int>(std::min<Uint64>((now - lastRenderCounter) * LOOPBACK_FREQUENCY / frequency, LOOPBACK_FREQUENCY)) };
+        renderAudio(nullptr, numFrames);
+
+        // keep the fraction of a frame that wasn't rendered yet
+        lastRenderCounter = numFrames < LOOPBACK_FREQUENCY ? lastRenderCounter + (Uint64)numFrames * frequency / LOOPBACK_FREQUENCY : now;
+    }
+
+    updateScrub();
+
     for(const auto & [sourceIdx, active] : musicSourcesActive) {
         if(active && isMusicPlaying(sourceIdx)) {
             updateBufferStream(window, sourceIdx);
@@ -201,7 +434,6 @@ bool AudioSystem::loadSound(std::string_view soundID, const fs::path & path) {
     alGenBuffers(1, &buffer);
     alBufferData(buffer, format, soundMembuf, num_bytes, soundSfinfo.samplerate);
 
-    free(soundMembuf);
     sf_close(soundSndfile);
 
     /* Check if an error occured, and clean up if so. */
@@ -210,15 +442,27 @@ bool AudioSystem::loadSound(std::string_view soundID, const fs::path & path) {
         if(buffer && alIsBuffer(buffer))
             alDeleteBuffers(1, &buffer);
 
+        free(soundMembuf);
         return false;
     }
 
-    if(soundBufferIDs.find(soundID) == soundBufferIDs.end()) {
-        soundBufferIDs.try_emplace(soundID, buffer);
+    if(soundHandles.find(std::string(soundID)) == soundHandles.end()) {
+        LoadedSound sound { buffer, {}, soundSfinfo.channels, soundSfinfo.samplerate };
+        if(soundSfinfo.channels <= 2) {
+            sound.samples.resize((size_t)(num_frames * soundSfinfo.channels));
+            for(size_t i = 0; i < sound.samples.size(); i++) {
+                sound.samples[i] = soundMembuf[i] / 32768.f;
+            }
+        }
+
+        soundHandles.try_emplace(std::string(soundID), static_cast<int>(loadedSounds.size()));
+        loadedSounds.push_back(std::move(sound));
     } else {
         alDeleteBuffers(1, &buffer);
     }
 
+    free(soundMembuf);
+
     return true;
 }
 
@@ -233,17 +477,15 @@ int AudioSystem::loadMusic(const fs::path & path) {
 
     if(nextIdx >= 0) {
         std::size_t frameSize;
-        if(sndfiles[nextIdx]) {
-            sf_close(sndfiles[nextIdx]);
-        }
 
-        sfInfos[nextIdx] = SF_INFO{};
-        sndfiles[nextIdx] = sf_open(path.string().c_str(), SFM_READ, &sfInfos[nextIdx]);
-        
-        if(!sndfiles[nextIdx]) {
+        // windows opening the same song share its decoder
+        musicAssets[nextIdx] = musicAssetCache.acquire(path);
+        if(!musicAssets[nextIdx]) {
             return -1;
         }
 
+        sfInfos[nextIdx] = musicAssets[nextIdx]->getInfo();
+
         frameSize = ((size_t)BUFFER_FRAMES * (size_t)sfInfos[nextIdx].channels) * sizeof(float);
 
         if(membufs[nextIdx]) {
@@ -251,6 +493,11 @@ int AudioSystem::loadMusic(const fs::path & path) {
         }
 
         membufs[nextIdx] = static_cast<float*>(malloc(frameSize));
+        outputbufs[nextIdx].resize((size_t)BUFFER_FRAMES * OUTPUT_CHANNELS);
+        downmixWeights[nextIdx] = sfInfos[nextIdx].channels > OUTPUT_CHANNELS ? getDownmixWeights(sfInfos[nextIdx].channels) : std::vector<float>{};
+        decodeFramePositions[nextIdx] = 0;
+        streamFramePositions[nextIdx] = 0.0;
+        playbackRates[nextIdx] = 1.0;
         musicSourcesActive[nextIdx] = true;
     }
 
@@ -259,44 +506,147 @@ int AudioSystem::loadMusic(const fs::path & path) {
 
 void AudioSystem::deactivateMusicSource(int sourceIdx) {
     if(sourceIdx < NUM_MUSIC_SOURCES && sourceIdx >= 0 && musicSourcesActive.at(sourceIdx)) {
-        sf_close(sndfiles[sourceIdx]);
+        musicAssets[sourceIdx].reset();
         free(membufs[sourceIdx]);
 
         sfInfos[sourceIdx] = SF_INFO{};
 
         musicStops[sourceIdx] = 0.f;
         stopMusicsEarly[sourceIdx] = false;
-        sndfiles[sourceIdx] = nullptr;
         membufs[sourceIdx] = nullptr;
 
+        outputbufs[sourceIdx] = std::vector<float>{};
+        downmixWeights[sourceIdx].clear();
+
+        clearMusicLoop(sourceIdx);
+        clearMetronome(sourceIdx);
+        if(scrubSourceIdx == sourceIdx) {
+            stopScrub();
+        }
+
+        clearHitsounds(sourceIdx);
         musicSourcesActive[sourceIdx] = false;
     }
 }
 
+bool AudioSystem::isSameMusic(int sourceIdx, int otherSourceIdx) const {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || otherSourceIdx < 0 || otherSourceIdx >= NUM_MUSIC_SOURCES) {
+        return false;
+    }
+
+    return musicAssets[sourceIdx] && musicAssets[sourceIdx] == musicAssets[otherSourceIdx];
+}
+
+int AudioSystem::getSoundHandle(std::string_view soundID) const {
+    auto handleIter = soundHandles.find(std::string(soundID));
+    return handleIter == soundHandles.end() ? -1 : handleIter->second;
+}
+
+void AudioSystem::playSound(int soundHandle) {
+    if(soundHandle < 0 || soundHandle >= static_cast<int>(loadedSounds.size())) {
+        return;
+    }
+
+    const auto & sound = loadedSounds[soundHandle];
+
+    // take the oldest voice; no AL state polling needed
+    int voice = nextSoundSource;
+    nextSoundSource = (nextSoundSource + 1) % NUM_SOUND_SOURCES;
+
+    if(soundBuffers[voice] != sound.buffer) {
+        // the buffer can only be swapped on a stopped source; output latency can keep a voice
+        // playing past its sound's length, so steal it unconditionally (a no-op if already stopped)
+        alSourceStop(soundSources[voice]);
+
+        soundBuffers[voice] = sound.buffer;
+        alSourcei(soundSources[voice], AL_BUFFER, (ALint) sound.buffer);
+    }
+
+    // playing an already playing source restarts it
+    alSourcePlay(soundSources[voice]);
+}
+
 void AudioSystem::playSound(std::string_view soundID) {
-    if(soundBufferIDs.find(soundID) == soundBufferIDs.end()) {
+    playSound(getSoundHandle(soundID));
+}
+
+void AudioSystem::setMetronome(int sourceIdx, std::vector<MetronomeSection> sections) {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || !musicSourcesActive.at(sourceIdx)) {
         return;
     }
 
-    auto bufferID = soundBufferIDs.at(soundID);
-    if(!(bufferID && alIsBuffer(bufferID))) {
+    // drop sections the clicks can't be placed in
+    sections.erase(std::remove_if(sections.begin(), sections.end(),
+        [](const MetronomeSection & section) { return section.bpm <= 0.0 || section.beatsPerMeasure < 1; }), sections.end());
+
+    if(sections.empty()) {
+        clearMetronome(sourceIdx);
         return;
     }
 
-    // find the next available sound buffer, and set it
-    for(int i = 0; i < NUM_SOUND_SOURCES; i++) {
-        ALint state;
-        alGetSourcei(soundSources[i], AL_SOURCE_STATE, &state);
+    const auto & sfinfo = sfInfos[sourceIdx];
+    if(beatClickSamples[sourceIdx].empty()) {
+        beatClickSamples[sourceIdx] = makeClick(1000.0, 0.5f, METRONOME_CLICK_SECONDS, sfinfo.channels, sfinfo.samplerate);
+        downbeatClickSamples[sourceIdx] = makeClick(1500.0, 0.7f, METRONOME_CLICK_SECONDS, sfinfo.channels, sfinfo.samplerate);
+    }
 
-        if(state != AL_PLAYING) {
-            if(bufferID != soundBuffers[i]) {
-                soundBuffers[i] = bufferID;
-                alSourcei(soundSources[i], AL_BUFFER, (ALint) soundBuffers[i]);
-            }
+    metronomeSections[sourceIdx] = std::move(sections);
+}
 
-            alSourcePlay(soundSources[i]);
-            return;
-        }
+void AudioSystem::clearMetronome(int sourceIdx) {
+    if(sourceIdx >= 0 && sourceIdx < NUM_MUSIC_SOURCES) {
+        metronomeSections[sourceIdx].clear();
+        beatClickSamples[sourceIdx].clear();
+        downbeatClickSamples[sourceIdx].clear();
+    }
+}
+
+void AudioSystem::setHitsounds(int sourceIdx, int soundHandle, const std::vector<double> & hitTimes) {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || !musicSourcesActive.at(sourceIdx)) {
+        return;
+    }
+
+    clearHitsounds(sourceIdx);
+
+    if(soundHandle < 0 || soundHandle >= static_cast<int>(loadedSounds.size()) || hitTimes.empty()) {
+        return;
+    }
+
+    hitsoundSamples[sourceIdx] = getHitsoundSamples(sourceIdx, soundHandle);
+    if(hitsoundSamples[sourceIdx].empty()) {
+        return;
+    }
+
+    hitsoundFrames[sourceIdx] = getHitsoundFrames(sfInfos[sourceIdx].samplerate, hitTimes);
+}
+
+std::vector<float> AudioSystem::getHitsoundSamples(int sourceIdx, int soundHandle) const {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || soundHandle < 0 || soundHandle >= static_cast<int>(loadedSounds.size())) {
+        return {};
+    }
+
+    const auto & sound = loadedSounds[soundHandle];
+    const auto & sfinfo = sfInfos[sourceIdx];
+
+    return convertSound(sound.samples, sound.channels, sound.samplerate, sfinfo.channels, sfinfo.samplerate);
+}
+
+std::vector<sf_count_t> AudioSystem::getHitsoundFrames(int samplerate, const std::vector<double> & hitTimes) {
+    std::vector<sf_count_t> frames;
+    frames.reserve(hitTimes.size());
+
+    for(auto hitTime : hitTimes) {
+        frames.push_back(static_cast<sf_count_t>(std::llround(hitTime * samplerate)));
+    }
+
+    std::sort(frames.begin(), frames.end());
+    return frames;
+}
+
+void AudioSystem::clearHitsounds(int sourceIdx) {
+    if(sourceIdx >= 0 && sourceIdx < NUM_MUSIC_SOURCES) {
+        hitsoundFrames[sourceIdx].clear();
+        hitsoundSamples[sourceIdx].clear();
     }
 }
 
@@ -316,17 +666,29 @@ void AudioSystem::setMusicPosition(int sourceIdx, float position) {
     alSourcei(musicSources[sourceIdx], AL_BUFFER, 0);
 
     auto numFramesToSeek = (sf_count_t)((position / getMusicLength(sourceIdx)) * sfInfos[sourceIdx].frames);
-    sf_seek(sndfiles[sourceIdx], numFramesToSeek, SEEK_SET);
+    decodeFramePositions[sourceIdx] = numFramesToSeek;
 
     lastBufferPositions[sourceIdx] = position;
+    streamFramePositions[sourceIdx] = static_cast<double>(numFramesToSeek);
+
+    musicLoops[sourceIdx].streamWrapsPending = 0;
+    musicLoops[sourceIdx].bufferWrapsPending = 0;
+
+    if(playbackRates[sourceIdx] != 1.0) {
+        timeStretchers[sourceIdx].reset(sfInfos[sourceIdx].channels, sfInfos[sourceIdx].samplerate, playbackRates[sourceIdx]);
+    }
+
+    if(sfInfos[sourceIdx].samplerate != deviceFrequency) {
+        resamplers[sourceIdx].reset(OUTPUT_CHANNELS, sfInfos[sourceIdx].samplerate, deviceFrequency);
+    }
 
     ALsizei b;
     for(b = 0; b < NUM_BUFFERS; b++) {
-        sf_count_t sndLen = sf_readf_float(sndfiles[sourceIdx], membufs[sourceIdx], BUFFER_FRAMES);
+        const float * frames;
+        sf_count_t sndLen = readOutputFrames(sourceIdx, frames);
         if(sndLen < 1) break;
 
-        sndLen *= sfInfos[sourceIdx].channels * (sf_count_t) sizeof(float);
-        alBufferData(musicBuffers[sourceIdx][b], musicFormat, membufs[sourceIdx], (ALsizei)sndLen, sfInfos[sourceIdx].samplerate);
+        bufferMusicFrames(musicBuffers[sourceIdx][b], frames, sndLen, deviceFrequency);
     }
 
     alSourceQueueBuffers(musicSources[sourceIdx], b, &musicBuffers[sourceIdx][0]);
@@ -340,14 +702,14 @@ float AudioSystem::getMusicLength(int sourceIdx) const {
 }
 
 float AudioSystem::getSongPosition(int sourceIdx) const {
-    if(sourceIdx < NUM_MUSIC_SOURCES)
+    if(!(sourceIdx < NUM_MUSIC_SOURCES))
         return 0.f;
 
-    // calculate position from the current buffer
+    // calculate position from the current buffer, which plays back at the playback rate
     float songPosSec;
     alGetSourcef(musicSources[sourceIdx], AL_SEC_OFFSET, &songPosSec);
 
-    return lastBufferPositions[sourceIdx] + songPosSec;
+    return lastBufferPositions[sourceIdx] + songPosSec * static_cast<float>(playbackRates[sourceIdx]);
 }
 
 void AudioSystem::resumeMusic(int sourceIdx) const {
@@ -379,6 +741,45 @@ bool AudioSystem::isMusicPlaying(int sourceIdx) const {
     return (state == AL_PLAYING && alGetError() == AL_NO_ERROR);
 }
 
+size_t AudioSystem::getMemoryUsage(int sourceIdx) const {
+    auto activeIter { musicSourcesActive.find(sourceIdx) };
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || activeIter == musicSourcesActive.end() || !activeIter->second) {
+        return 0;
+    }
+
+    size_t bytes { membufs[sourceIdx] ? static_cast<size_t>(BUFFER_FRAMES) * sfInfos[sourceIdx].channels * sizeof(float) : 0 };
+
+    size_t floats { outputbufs[sourceIdx].capacity() + downmixWeights[sourceIdx].capacity() + hitsoundSamples[sourceIdx].capacity() +
+        beatClickSamples[sourceIdx].capacity() + downbeatClickSamples[sourceIdx].capacity() + musicLoops[sourceIdx].samples.capacity() };
+    bytes += floats * sizeof(float);
+
+    bytes += hitsoundFrames[sourceIdx].capacity() * sizeof(sf_count_t);
+    bytes += metronomeSections[sourceIdx].capacity() * sizeof(MetronomeSection);
+    bytes += timeStretchers[sourceIdx].getMemoryUsage() + resamplers[sourceIdx].getMemoryUsage();
+
+    if(musicAssets[sourceIdx]) {
+        bytes += musicAssets[sourceIdx]->getMemoryUsage() / musicAssets[sourceIdx].use_count();
+    }
+
+    return bytes;
+}
+
+bool AudioSystem::isActive() const {
+    for(const auto & [sourceIdx, active] : musicSourcesActive) {
+        if(active && isMusicPlaying(sourceIdx)) {
+            return true;
+        }
+    }
+
+    if(scrubSourceIdx >= 0) {
+        ALint state;
+        alGetSourcei(scrubSource, AL_SOURCE_STATE, &state);
+        return scrubPending || state == AL_PLAYING;
+    }
+
+    return false;
+}
+
 bool AudioSystem::isMusicPaused(int sourceIdx) const {
     if(!(sourceIdx < NUM_MUSIC_SOURCES))
         return false;
@@ -393,6 +794,8 @@ void AudioSystem::updateBufferStream(SDL_Window * window, int sourceIdx) {
     if(!(sourceIdx < NUM_MUSIC_SOURCES))
         return;
 
+    TRACE_SCOPE("Music streaming");
+
     ALint processed;
     ALint state;
 
@@ -404,23 +807,32 @@ void AudioSystem::updateBufferStream(SDL_Window * window, int sourceIdx) {
     while(processed > 0) {
     ALuint bufid;
     sf_count_t slen;
+    const float * frames;
 
         alSourceUnqueueBuffers(musicSources[sourceIdx], 1, &bufid);
         processed--;
 
-        lastBufferPositions[sourceIdx] += getBufferLength(bufid);
+        lastBufferPositions[sourceIdx] += getBufferLength(bufid) * static_cast<float>(playbackRates[sourceIdx]);
+
+        // the buffer now playing started back at the loop start
+        if(auto & loop = musicLoops[sourceIdx]; loop.bufferWrapsPending > 0) {
+            auto samplerate { static_cast<float>(sfInfos[sourceIdx].samplerate) };
+            if(lastBufferPositions[sourceIdx] >= (static_cast<float>(loop.endFrame) - 0.5f) / samplerate) {
+                lastBufferPositions[sourceIdx] -= static_cast<float>(loop.endFrame - loop.startFrame) / samplerate;
+                loop.bufferWrapsPending--;
+            }
+        }
 
         /* Read the next chunk of data, refill the buffer, and queue it
          * back on the source */
-        slen = sf_readf_float(sndfiles[sourceIdx], membufs[sourceIdx], BUFFER_FRAMES);
+        slen = readOutputFrames(sourceIdx, frames);
         if(slen > 0) {
-            slen *= sfInfos[sourceIdx].channels * (sf_count_t)sizeof(float);
-            alBufferData(bufid, musicFormat, membufs[sourceIdx], (ALsizei)slen, sfInfos[sourceIdx].samplerate);
+            bufferMusicFrames(bufid, frames, slen, deviceFrequency);
             alSourceQueueBuffers(musicSources[sourceIdx], 1, &bufid);
         }
 
         if(alGetError() != AL_NO_ERROR) {
-            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Music playback error", "Error buffering music data", window);
+            reportError(window, "Music playback error", "Error buffering music data");
         }
     }
 
@@ -437,6 +849,387 @@ void AudioSystem::updateBufferStream(SDL_Window * window, int sourceIdx) {
     }
 }
 
+sf_count_t AudioSystem::readOutputFrames(int sourceIdx, const float *& frames) {
+    if(sfInfos[sourceIdx].samplerate == deviceFrequency) {
+        sf_count_t numFrames = readMusicFrames(sourceIdx, frames);
+        if(numFrames > 0) {
+            frames = remixMusicFrames(sourceIdx, frames, numFrames);
+        }
+
+        return numFrames;
+    }
+
+    // resample until there's a full buffer; the resampler copies its input, so outputbufs can be reused
+    auto & resampler = resamplers[sourceIdx];
+    while(resampler.getOutputFrames() < BUFFER_FRAMES && !resampler.isFinished()) {
+        const float * musicFrames;
+        sf_count_t numRead = readMusicFrames(sourceIdx, musicFrames);
+        if(numRead > 0) {
+            resampler.pushInput(remixMusicFrames(sourceIdx, musicFrames, numRead), (size_t)numRead);
+        } else {
+            resampler.finish();
+        }
+    }
+
+    frames = outputbufs[sourceIdx].data();
+    return (sf_count_t)resampler.pullOutput(outputbufs[sourceIdx].data(), BUFFER_FRAMES);
+}
+
+const float * AudioSystem::remixMusicFrames(int sourceIdx, const float * frames, sf_count_t numFrames) {
+    int channels { sfInfos[sourceIdx].channels };
+    if(channels == OUTPUT_CHANNELS) {
+        return frames;
+    }
+
+    float * remixed { outputbufs[sourceIdx].data() };
+    if(channels == 1) {
+        simd::monoToStereo(remixed, frames, (size_t)numFrames);
+    } else {
+        const auto & weights = downmixWeights[sourceIdx];
+        simd::downmixToStereo(remixed, frames, (size_t)numFrames, channels, weights.data(), weights.data() + channels);
+    }
+
+    return remixed;
+}
+
+void AudioSystem::bufferMusicFrames(ALuint buffer, const float * frames, sf_count_t numFrames, int samplerate) {
+    auto numSamples { (size_t)numFrames * OUTPUT_CHANNELS };
+
+#ifdef __APPLE__
+    deviceSamples.resize(numSamples);
+    simd::floatToInt16(deviceSamples.data(), frames, numSamples);
+    alBufferData(buffer, musicFormat, deviceSamples.data(), (ALsizei)(numSamples * sizeof(std::int16_t)), samplerate);
+#else
+    alBufferData(buffer, musicFormat, frames, (ALsizei)(numSamples * sizeof(float)), samplerate);
+#endif
+}
+
+sf_count_t AudioSystem::readMusicFrames(int sourceIdx, const float *& frames) {
+    sf_count_t numFrames;
+    double rate { playbackRates[sourceIdx] };
+
+    frames = membufs[sourceIdx];
+
+    if(rate == 1.0 && hitsoundFrames[sourceIdx].empty() && metronomeSections[sourceIdx].empty() && !musicLoops[sourceIdx].active) {
+        if(const float * mappedFrames = readMappedFrames(sourceIdx, numFrames)) {
+            frames = mappedFrames;
+            streamFramePositions[sourceIdx] += numFrames;
+            return numFrames;
+        }
+    }
+
+    if(rate == 1.0) {
+        numFrames = readDecodedFrames(sourceIdx);
+    } else {
+        // decode through the stretcher until it has a full buffer, reusing membufs for the input
+        auto & stretcher = timeStretchers[sourceIdx];
+        while(stretcher.getOutputFrames() < BUFFER_FRAMES && !stretcher.isFinished()) {
+            sf_count_t numRead = readDecodedFrames(sourceIdx);
+            if(numRead > 0) {
+                stretcher.pushInput(membufs[sourceIdx], (size_t)numRead);
+            } else {
+                stretcher.finish();
+            }
+        }
+
+        numFrames = (sf_count_t)stretcher.pullOutput(membufs[sourceIdx], BUFFER_FRAMES);
+    }
+
+    // hitsounds go in after stretching, so they keep their own length at any rate
+    if(numFrames > 0) {
+        mixHitsounds(sourceIdx, streamFramePositions[sourceIdx], numFrames);
+        mixMetronome(sourceIdx, streamFramePositions[sourceIdx], numFrames);
+        streamFramePositions[sourceIdx] += numFrames * rate;
+
+        auto & loop = musicLoops[sourceIdx];
+        if(loop.streamWrapsPending > 0 && streamFramePositions[sourceIdx] >= static_cast<double>(loop.endFrame)) {
+            streamFramePositions[sourceIdx] -= static_cast<double>(loop.endFrame - loop.startFrame);
+            loop.streamWrapsPending--;
+        }
+    }
+
+    return numFrames;
+}
+
+sf_count_t AudioSystem::readDecodedFrames(int sourceIdx) {
+    auto & loop = musicLoops[sourceIdx];
+    auto & position = decodeFramePositions[sourceIdx];
+
+    // reads stop at the loop end, so at normal speed no buffer straddles the wrap
+    if(loop.active && position < loop.endFrame) {
+        int channels { sfInfos[sourceIdx].channels };
+        sf_count_t numFrames { std::min<sf_count_t>(BUFFER_FRAMES, loop.endFrame - position) };
+
+        if(position >= loop.startFrame) {
+            std::copy_n(loop.samples.data() + (position - loop.startFrame) * channels, numFrames * channels, membufs[sourceIdx]);
+        } else {
+            numFrames = musicAssets[sourceIdx]->readFrames(position, membufs[sourceIdx], numFrames);
+        }
+
+        position += numFrames;
+        if(position >= loop.endFrame) {
+            position = loop.startFrame;
+            loop.streamWrapsPending++;
+            loop.bufferWrapsPending++;
+        }
+
+        return numFrames;
+    }
+
+    sf_count_t numFrames = musicAssets[sourceIdx]->readFrames(decodeFramePositions[sourceIdx], membufs[sourceIdx], BUFFER_FRAMES);
+    decodeFramePositions[sourceIdx] += numFrames;
+
+    return numFrames;
+}
+
+const float * AudioSystem::readMappedFrames(int sourceIdx, sf_count_t & numFrames) {
+    numFrames = BUFFER_FRAMES;
+    const float * frames { musicAssets[sourceIdx]->getMappedFrames(decodeFramePositions[sourceIdx], numFrames) };
+    if(frames) {
+        decodeFramePositions[sourceIdx] += numFrames;
+    }
+
+    return frames;
+}
+
+void AudioSystem::mixHitsounds(int sourceIdx, double startFrame, sf_count_t numFrames) {
+    // the music source gain scales the mixed hitsounds as well, so undo it for the sound volume
+    float gain { musicGain > 0.f ? std::min(soundGain / musicGain, MAX_HITSOUND_MIX_GAIN) : 0.f };
+
+    mixSound(membufs[sourceIdx], sfInfos[sourceIdx].channels, startFrame, numFrames, playbackRates[sourceIdx],
+        hitsoundFrames[sourceIdx], hitsoundSamples[sourceIdx], gain);
+}
+
+void AudioSystem::mixMetronome(int sourceIdx, double startFrame, sf_count_t numFrames) {
+    const auto & sections = metronomeSections[sourceIdx];
+    if(sections.empty()) {
+        return;
+    }
+
+    double rate { playbackRates[sourceIdx] };
+    auto samplerate { static_cast<double>(sfInfos[sourceIdx].samplerate) };
+
+    // clicks that began shortly before the buffer still ring into it
+    double startTime { startFrame / samplerate - METRONOME_CLICK_SECONDS * rate };
+    double endTime { (startFrame + numFrames * rate) / samplerate };
+
+    beatClickFrames.clear();
+    downbeatClickFrames.clear();
+
+    auto sectionIter { std::upper_bound(sections.begin(), sections.end(), startTime,
+        [](double time, const MetronomeSection & section) { return time < section.startTime; }) };
+    if(sectionIter != sections.begin()) {
+        sectionIter--;
+    }
+
+    for(; sectionIter != sections.end() && sectionIter->startTime < endTime; sectionIter++) {
+        auto nextIter { std::next(sectionIter) };
+        double sectionEnd { nextIter != sections.end() ? nextIter->startTime : endTime };
+
+        double spb { 60.0 / sectionIter->bpm };
+        double firstBeat { sectionIter->startMeasure * sectionIter->beatsPerMeasure };
+        double fromTime { std::max(startTime, sectionIter->startTime) };
+
+        // beats on this section's measure grid, which may start mid-measure
+        auto beat { static_cast<sf_count_t>(std::ceil(firstBeat + (fromTime - sectionIter->startTime) / spb - 1e-9)) };
+        for(;; beat++) {
+            double beatTime { sectionIter->startTime + (static_cast<double>(beat) - firstBeat) * spb };
+            if(beatTime >= endTime || beatTime >= sectionEnd) {
+                break;
+            }
+
+            auto & frames { beat % sectionIter->beatsPerMeasure == 0 ? downbeatClickFrames : beatClickFrames };
+            frames.push_back(static_cast<sf_count_t>(std::llround(beatTime * samplerate)));
+        }
+    }
+
+    float gain { musicGain > 0.f ? std::min(soundGain / musicGain, MAX_HITSOUND_MIX_GAIN) : 0.f };
+    int channels { sfInfos[sourceIdx].channels };
+
+    mixSound(membufs[sourceIdx], channels, startFrame, numFrames, rate, beatClickFrames, beatClickSamples[sourceIdx], gain);
+    mixSound(membufs[sourceIdx], channels, startFrame, numFrames, rate, downbeatClickFrames, downbeatClickSamples[sourceIdx], gain);
+}
+
+void AudioSystem::mixSound(float * buffer, int channels, double startFrame, sf_count_t numFrames, double rate,
+    const std::vector<sf_count_t> & hits, const std::vector<float> & samples, float gain)
+{
+    auto soundFrames { static_cast<sf_count_t>(samples.size() / channels) };
+    if(hits.empty() || soundFrames < 1) {
+        return;
+    }
+
+    // buffer frames advance through the music at the playback rate, hitsound frames at 1
+    double endFrame { startFrame + numFrames * rate };
+
+    // first hit whose sound still overlaps this buffer
+    auto firstHit { static_cast<sf_count_t>(std::floor(startFrame - soundFrames * rate)) };
+    auto hitIter { std::upper_bound(hits.begin(), hits.end(), firstHit) };
+    for(; hitIter != hits.end() && *hitIter < endFrame; hitIter++) {
+        auto hitOffset { static_cast<sf_count_t>(std::llround((*hitIter - startFrame) / rate)) };
+
+        sf_count_t soundOffset { std::max<sf_count_t>(0, -hitOffset) };
+        sf_count_t bufferOffset { std::max<sf_count_t>(0, hitOffset) };
+        sf_count_t count { std::min(soundFrames - soundOffset, numFrames - bufferOffset) };
+        if(count < 1) {
+            continue;
+        }
+
+        simd::mixAdd(buffer + bufferOffset * channels, samples.data() + soundOffset * channels,
+            static_cast<size_t>(count * channels), gain);
+    }
+}
+
+void AudioSystem::scrubMusic(int sourceIdx, float position) {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || !musicAssets[sourceIdx] || isMusicPlaying(sourceIdx)) {
+        return;
+    }
+
+    if(scrubSourceIdx != sourceIdx) {
+        stopScrub();
+        scrubSourceIdx = sourceIdx;
+    }
+
+    scrubPosition = position;
+    scrubPending = true;
+
+    updateScrub();
+}
+
+void AudioSystem::stopScrub() {
+    alSourceStop(scrubSource);
+
+    // a stopped source has processed all of its buffers
+    ALint processed { 0 };
+    alGetSourcei(scrubSource, AL_BUFFERS_PROCESSED, &processed);
+    while(processed-- > 0) {
+        ALuint bufid;
+        alSourceUnqueueBuffers(scrubSource, 1, &bufid);
+        freeScrubBuffers.push_back(bufid);
+    }
+
+    scrubSourceIdx = -1;
+    scrubPending = false;
+}
+
+void AudioSystem::updateScrub() {
+    if(scrubSourceIdx < 0) {
+        return;
+    }
+
+    // normal playback takes over from scrubbing
+    if(isMusicPlaying(scrubSourceIdx)) {
+        stopScrub();
+        return;
+    }
+
+    ALint processed { 0 };
+    alGetSourcei(scrubSource, AL_BUFFERS_PROCESSED, &processed);
+    while(processed-- > 0) {
+        ALuint bufid;
+        alSourceUnqueueBuffers(scrubSource, 1, &bufid);
+        freeScrubBuffers.push_back(bufid);
+    }
+
+    ALint queued { 0 };
+    alGetSourcei(scrubSource, AL_BUFFERS_QUEUED, &queued);
+    if(scrubPending && queued < MAX_SCRUB_GRAINS_QUEUED && !freeScrubBuffers.empty()) {
+        scrubPending = false;
+
+        if(queueScrubGrain()) {
+            ALint state;
+            alGetSourcei(scrubSource, AL_SOURCE_STATE, &state);
+            if(state != AL_PLAYING) {
+                alSourcePlay(scrubSource);
+            }
+        }
+    }
+}
+
+bool AudioSystem::queueScrubGrain() {
+    const auto & sfinfo = sfInfos[scrubSourceIdx];
+
+    auto grainFrames { std::min<sf_count_t>(BUFFER_FRAMES, std::lround(SCRUB_GRAIN_SECONDS * sfinfo.samplerate)) };
+    auto startFrame { static_cast<sf_count_t>(std::llround(scrubPosition * sfinfo.samplerate)) };
+    if(startFrame < 0 || startFrame >= sfinfo.frames) {
+        return false;
+    }
+
+    // grains come from the shared asset, so its seek index or mapping keeps them cheap
+    scrubSamples.resize(static_cast<size_t>(grainFrames * sfinfo.channels));
+    sf_count_t numFrames = musicAssets[scrubSourceIdx]->readFrames(startFrame, scrubSamples.data(), grainFrames);
+    if(numFrames < 1) {
+        return false;
+    }
+
+    // stereo frames, in a buffer of our own to apply the fades
+    const float * frames { remixMusicFrames(scrubSourceIdx, scrubSamples.data(), numFrames) };
+    scrubGrain.assign(frames, frames + numFrames * OUTPUT_CHANNELS);
+
+    auto fadeFrames { std::min<sf_count_t>(numFrames / 2, std::lround(SCRUB_FADE_SECONDS * sfinfo.samplerate)) };
+    for(sf_count_t i = 0; i < fadeFrames; i++) {
+        auto gain { static_cast<float>(0.5 - 0.5 * std::cos(PI * (static_cast<double>(i) + 0.5) / static_cast<double>(fadeFrames))) };
+        for(int c = 0; c < OUTPUT_CHANNELS; c++) {
+            scrubGrain[i * OUTPUT_CHANNELS + c] *= gain;
+            scrubGrain[(numFrames - 1 - i) * OUTPUT_CHANNELS + c] *= gain;
+        }
+    }
+
+    ALuint buffer { freeScrubBuffers.back() };
+    freeScrubBuffers.pop_back();
+
+    bufferMusicFrames(buffer, scrubGrain.data(), numFrames, sfinfo.samplerate);
+    alSourcef(scrubSource, AL_GAIN, musicGain);
+    alSourceQueueBuffers(scrubSource, 1, &buffer);
+
+    return true;
+}
+
+bool AudioSystem::setMusicLoop(int sourceIdx, float loopStart, float loopEnd) {
+    if(sourceIdx < 0 || sourceIdx >= NUM_MUSIC_SOURCES || !musicAssets[sourceIdx]) {
+        return false;
+    }
+
+    const auto & sfinfo = sfInfos[sourceIdx];
+    auto startFrame { std::clamp<sf_count_t>(std::llround(loopStart * sfinfo.samplerate), 0, sfinfo.frames) };
+    auto endFrame { std::clamp<sf_count_t>(std::llround(loopEnd * sfinfo.samplerate), 0, sfinfo.frames) };
+    if(endFrame <= startFrame) {
+        clearMusicLoop(sourceIdx);
+        return false;
+    }
+
+    auto & loop = musicLoops[sourceIdx];
+    if(loop.active && loop.startFrame == startFrame && loop.endFrame == endFrame) {
+        return true;
+    }
+
+    // decode the whole loop now, so playing it never has to seek
+    std::vector<float> samples(static_cast<size_t>((endFrame - startFrame) * sfinfo.channels), 0.f);
+    for(sf_count_t decoded = 0; decoded < endFrame - startFrame;) {
+        sf_count_t numRead = musicAssets[sourceIdx]->readFrames(startFrame + decoded, samples.data() + decoded * sfinfo.channels,
+            endFrame - startFrame - decoded);
+        if(numRead < 1) {
+            break;
+        }
+
+        decoded += numRead;
+    }
+
+    loop.active = true;
+    loop.startFrame = startFrame;
+    loop.endFrame = endFrame;
+    loop.samples = std::move(samples);
+    loop.streamWrapsPending = 0;
+    loop.bufferWrapsPending = 0;
+
+    return true;
+}
+
+void AudioSystem::clearMusicLoop(int sourceIdx) {
+    if(sourceIdx >= 0 && sourceIdx < NUM_MUSIC_SOURCES) {
+        musicLoops[sourceIdx] = MusicLoop{};
+    }
+}
+
 float AudioSystem::getBufferLength(ALuint bufid) const {
     ALint bytesize;
     ALint channels;
@@ -476,6 +1269,16 @@ float AudioSystem::getMusicStop(int sourceIdx) const {
     return sourceIdx < NUM_MUSIC_SOURCES ? musicStops[sourceIdx] : 0;
 }
 
+void AudioSystem::setPlaybackRate(int sourceIdx, double rate) {
+    if(sourceIdx >= 0 && sourceIdx < NUM_MUSIC_SOURCES) {
+        playbackRates[sourceIdx] = std::clamp(rate, MIN_PLAYBACK_RATE, MAX_PLAYBACK_RATE);
+    }
+}
+
+double AudioSystem::getPlaybackRate(int sourceIdx) const {
+    return sourceIdx >= 0 && sourceIdx < NUM_MUSIC_SOURCES ? playbackRates[sourceIdx] : 1.0;
+}
+
 void AudioSystem::setMusicVolume(float gain) {
     if(gain < 0) {
         gain = 0;
@@ -483,12 +1286,16 @@ void AudioSystem::setMusicVolume(float gain) {
         gain = 1;
     }
 
+    musicGain = gain;
+
     for(int i = 0; i < NUM_MUSIC_SOURCES; i++) {
         alSourcef(musicSources[i], AL_GAIN, gain);
     }
 }
 
 void AudioSystem::setSoundVolume(float gain) {
+    soundGain = gain;
+
     for(int i = 0; i < NUM_SOUND_SOURCES; i++) {
         auto source = soundSources[i];
         alSourcef(source, AL_GAIN, gain);
@@ -0,0 +1,162 @@
+#include "systems/fft.hpp"
+#include "systems/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(TYPECHART_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(TYPECHART_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+namespace {
+    constexpr double PI { 3.14159265358979323846 };
+}
+
+FFT::FFT(std::size_t size)
+    : size(size)
+    , window(size)
+    , complexSize(std::max<std::size_t>(size / 2, 1))
+    , twiddleRe(complexSize)
+    , twiddleIm(complexSize)
+    , splitRe(complexSize + 1)
+    , splitIm(complexSize + 1)
+    , re(complexSize)
+    , im(complexSize) {
+    for(std::size_t i = 0; i < size; i++) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / size));
+    }
+
+    unsigned int numBits { 0 };
+    while((static_cast<std::size_t>(1) << numBits) < complexSize) {
+        numBits++;
+    }
+
+    bitReversed.resize(complexSize);
+    for(std::size_t i = 0; i < complexSize; i++) {
+        std::size_t reversed { 0 };
+        for(unsigned int bit = 0; bit < numBits; bit++) {
+            reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+        }
+
+        bitReversed[i] = reversed;
+    }
+
+    for(std::size_t half = 1; half < complexSize; half *= 2) {
+        for(std::size_t k = 0; k < half; k++) {
+            double angle { -PI * k / half };
+            twiddleRe[half - 1 + k] = static_cast<float>(std::cos(angle));
+            twiddleIm[half - 1 + k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    for(std::size_t k = 0; k <= complexSize; k++) {
+        double angle { -2.0 * PI * k / size };
+        splitRe[k] = static_cast<float>(std::cos(angle));
+        splitIm[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+std::size_t FFT::getSize() const {
+    return size;
+}
+
+std::size_t FFT::getNumBins() const {
+    return size / 2 + 1;
+}
+
+void FFT::magnitudes(const float * input, float * magnitudesOut) {
+    // pack even samples into the real part, odd samples into the imaginary part
+    for(std::size_t i = 0; i < complexSize; i++) {
+        re[bitReversed[i]] = input[i * 2] * window[i * 2];
+        im[bitReversed[i]] = input[i * 2 + 1] * window[i * 2 + 1];
+    }
+
+    transform();
+
+    for(std::size_t k = 0; k <= complexSize; k++) {
+        std::size_t k0 { k % complexSize };
+        std::size_t k1 { (complexSize - k) % complexSize };
+
+        // even/odd spectra from Z[k] and conj(Z[N/2 - k])
+        float evenRe { 0.5f * (re[k0] + re[k1]) };
+        float evenIm { 0.5f * (im[k0] - im[k1]) };
+        float oddRe { 0.5f * (im[k0] + im[k1]) };
+        float oddIm { -0.5f * (re[k0] - re[k1]) };
+
+        float binRe { evenRe + splitRe[k] * oddRe - splitIm[k] * oddIm };
+        float binIm { evenIm + splitRe[k] * oddIm + splitIm[k] * oddRe };
+        magnitudesOut[k] = std::sqrt(binRe * binRe + binIm * binIm);
+    }
+}
+
+void FFT::transform() {
+    for(std::size_t half = 1; half < complexSize; half *= 2) {
+        butterflies(half, twiddleRe.data() + half - 1, twiddleIm.data() + half - 1);
+    }
+}
+
+void FFT::butterflies(std::size_t half, const float * wRe, const float * wIm) {
+    float * xRe { re.data() };
+    float * xIm { im.data() };
+
+    for(std::size_t start = 0; start < complexSize; start += half * 2) {
+        std::size_t k { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            for(; k + 4 <= half; k += 4) {
+                std::size_t a { start + k };
+                std::size_t b { a + half };
+
+                __m128 aRe { _mm_loadu_ps(xRe + a) };
+                __m128 aIm { _mm_loadu_ps(xIm + a) };
+                __m128 bRe { _mm_loadu_ps(xRe + b) };
+                __m128 bIm { _mm_loadu_ps(xIm + b) };
+                __m128 twRe { _mm_loadu_ps(wRe + k) };
+                __m128 twIm { _mm_loadu_ps(wIm + k) };
+
+                __m128 tRe { _mm_sub_ps(_mm_mul_ps(bRe, twRe), _mm_mul_ps(bIm, twIm)) };
+                __m128 tIm { _mm_add_ps(_mm_mul_ps(bRe, twIm), _mm_mul_ps(bIm, twRe)) };
+
+                _mm_storeu_ps(xRe + b, _mm_sub_ps(aRe, tRe));
+                _mm_storeu_ps(xIm + b, _mm_sub_ps(aIm, tIm));
+                _mm_storeu_ps(xRe + a, _mm_add_ps(aRe, tRe));
+                _mm_storeu_ps(xIm + a, _mm_add_ps(aIm, tIm));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            for(; k + 4 <= half; k += 4) {
+                std::size_t a { start + k };
+                std::size_t b { a + half };
+
+                float32x4_t aRe { vld1q_f32(xRe + a) };
+                float32x4_t aIm { vld1q_f32(xIm + a) };
+                float32x4_t bRe { vld1q_f32(xRe + b) };
+                float32x4_t bIm { vld1q_f32(xIm + b) };
+                float32x4_t twRe { vld1q_f32(wRe + k) };
+                float32x4_t twIm { vld1q_f32(wIm + k) };
+
+                float32x4_t tRe { vsubq_f32(vmulq_f32(bRe, twRe), vmulq_f32(bIm, twIm)) };
+                float32x4_t tIm { vaddq_f32(vmulq_f32(bRe, twIm), vmulq_f32(bIm, twRe)) };
+
+                vst1q_f32(xRe + b, vsubq_f32(aRe, tRe));
+                vst1q_f32(xIm + b, vsubq_f32(aIm, tIm));
+                vst1q_f32(xRe + a, vaddq_f32(aRe, tRe));
+                vst1q_f32(xIm + a, vaddq_f32(aIm, tIm));
+            }
+        #endif
+
+        for(; k < half; k++) {
+            std::size_t a { start + k };
+            std::size_t b { a + half };
+
+            float tRe { xRe[b] * wRe[k] - xIm[b] * wIm[k] };
+            float tIm { xRe[b] * wIm[k] + xIm[b] * wRe[k] };
+
+            xRe[b] = xRe[a] - tRe;
+            xIm[b] = xIm[a] - tIm;
+            xRe[a] += tRe;
+            xIm[a] += tIm;
+        }
+    }
+}
@@ -0,0 +1,208 @@
+#include "systems/mixdownexporter.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#include "systems/audiosystem.hpp"
+#include "systems/tracer.hpp"
+
+MixdownExporter::~MixdownExporter() {
+    stop();
+}
+
+bool MixdownExporter::start(const fs::path & musicPath, const fs::path & outputPath, std::vector<float> soundSamples, const std::vector<double> & hitTimes) {
+    stop();
+
+    this->musicPath = musicPath;
+    this->outputPath = outputPath;
+    this->soundSamples = std::move(soundSamples);
+
+    mixedBlocks.clear();
+    nextWriteBlock = 0;
+    nextMixBlock = 0;
+    progress = 0.f;
+    finished = false;
+    failed = false;
+    stopExport = false;
+
+    musicInfo = SF_INFO{};
+    SNDFILE * musicFile = sf_open(musicPath.string().c_str(), SFM_READ, &musicInfo);
+    if(!musicFile) {
+        failed = true;
+        return false;
+    }
+
+    sf_close(musicFile);
+
+    if(musicInfo.frames <= 0 || musicInfo.channels <= 0 || musicInfo.samplerate <= 0) {
+        failed = true;
+        return false;
+    }
+
+    SF_INFO outputInfo {};
+    outputInfo.samplerate = musicInfo.samplerate;
+    outputInfo.channels = musicInfo.channels;
+    outputInfo.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+
+    SNDFILE * outputFile = sf_open(outputPath.string().c_str(), SFM_WRITE, &outputInfo);
+    if(!outputFile) {
+        failed = true;
+        return false;
+    }
+
+    // hitsounds can push the mix past full scale; clip instead of wrapping around
+    sf_command(outputFile, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+
+    hitFrames = AudioSystem::getHitsoundFrames(musicInfo.samplerate, hitTimes);
+    numBlocks = (musicInfo.frames + BLOCK_FRAMES - 1) / BLOCK_FRAMES;
+
+    exportThread = std::thread(&MixdownExporter::exportMixdown, this, outputFile);
+    return true;
+}
+
+void MixdownExporter::stop() {
+    signal(stopExport);
+
+    if(exportThread.joinable()) {
+        exportThread.join();
+    }
+}
+
+bool MixdownExporter::isRunning() const {
+    return exportThread.joinable() && !finished && !failed;
+}
+
+bool MixdownExporter::isFinished() const {
+    return finished;
+}
+
+bool MixdownExporter::hasFailed() const {
+    return failed;
+}
+
+float MixdownExporter::getProgress() const {
+    return progress;
+}
+
+void MixdownExporter::exportMixdown(SNDFILE * outputFile) {
+    TRACE_THREAD_NAME("Mixdown writer");
+    TRACE_SCOPE("Export mixdown");
+
+    int numWorkers { std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1, MAX_WORKERS) };
+    maxBlocksInFlight = numWorkers * BLOCKS_IN_FLIGHT_PER_WORKER;
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i < numWorkers; i++) {
+        workers.emplace_back(&MixdownExporter::mixBlocks, this);
+    }
+
+    for(sf_count_t block = 0; block < numBlocks; block++) {
+        std::vector<float> samples;
+
+        {
+            std::unique_lock<std::mutex> lock(blockMutex);
+            blockMixed.wait(lock, [&] { return stopExport || failed || mixedBlocks.count(block) > 0; });
+
+            if(stopExport || failed) {
+                break;
+            }
+
+            samples = std::move(mixedBlocks.at(block));
+            mixedBlocks.erase(block);
+            nextWriteBlock = block + 1;
+        }
+
+        blockWritten.notify_all();
+
+        auto numFrames { static_cast<sf_count_t>(samples.size()) / musicInfo.channels };
+        if(sf_writef_float(outputFile, samples.data(), numFrames) != numFrames) {
+            signal(failed);
+            break;
+        }
+
+        progress = static_cast<float>(block + 1) / static_cast<float>(numBlocks);
+    }
+
+    // release any worker still waiting for room
+    bool completed { !stopExport && !failed };
+    signal(stopExport);
+
+    for(auto & worker : workers) {
+        worker.join();
+    }
+
+    sf_close(outputFile);
+
+    if(!completed) {
+        std::error_code ec;
+        fs::remove(outputPath, ec);
+    }
+
+    finished = completed;
+}
+
+void MixdownExporter::mixBlocks() {
+    TRACE_THREAD_NAME("Mixdown worker");
+
+    SF_INFO sfinfo {};
+    SNDFILE * sndfile = sf_open(musicPath.string().c_str(), SFM_READ, &sfinfo);
+    if(!sndfile) {
+        signal(failed);
+        return;
+    }
+
+    sf_count_t decoderFrame { 0 };
+
+    while(!stopExport) {
+        sf_count_t block { nextMixBlock++ };
+        if(block >= numBlocks) {
+            break;
+        }
+
+        // don't run too far ahead of the writer
+        {
+            std::unique_lock<std::mutex> lock(blockMutex);
+            blockWritten.wait(lock, [&] { return stopExport || block < nextWriteBlock + maxBlocksInFlight; });
+        }
+
+        if(stopExport) {
+            break;
+        }
+
+        TRACE_SCOPE("Mix block");
+
+        sf_count_t startFrame { block * BLOCK_FRAMES };
+        sf_count_t numFrames { std::min(BLOCK_FRAMES, musicInfo.frames - startFrame) };
+
+        if(decoderFrame != startFrame) {
+            decoderFrame = sf_seek(sndfile, startFrame, SEEK_SET);
+        }
+
+        // a short read leaves silence, keeping the output the length of the music
+        std::vector<float> samples(static_cast<size_t>(numFrames * musicInfo.channels), 0.f);
+        if(decoderFrame == startFrame) {
+            decoderFrame += sf_readf_float(sndfile, samples.data(), numFrames);
+        }
+
+        AudioSystem::mixSound(samples.data(), musicInfo.channels, static_cast<double>(startFrame), numFrames, 1.0, hitFrames, soundSamples, 1.f);
+
+        {
+            std::lock_guard<std::mutex> lock(blockMutex);
+            mixedBlocks.emplace(block, std::move(samples));
+        }
+
+        blockMixed.notify_all();
+    }
+
+    sf_close(sndfile);
+}
+
+void MixdownExporter::signal(std::atomic<bool> & flag) {
+    {
+        std::lock_guard<std::mutex> lock(blockMutex);
+        flag = true;
+    }
+
+    blockMixed.notify_all();
+    blockWritten.notify_all();
+}
@@ -0,0 +1,184 @@
+#include "systems/profiler.hpp"
+
+#ifdef TYPECHART_PROFILER
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "imgui.h"
+
+namespace {
+    constexpr std::array<const char *, static_cast<size_t>(Profiler::Zone::COUNT)> ZONE_NAMES {
+        "Audio update",
+        "Sequencer",
+        "Notes update",
+        "Chart data",
+        "Chart load",
+        "Chart save",
+        "Render"
+    };
+
+    double toMS(Uint64 ticks) {
+        return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    // values must be sorted
+    double percentile(const std::vector<double> & values, double p) {
+        if(values.empty()) {
+            return 0.0;
+        }
+
+        auto idx { static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5) };
+        return values[std::min(idx, values.size() - 1)];
+    }
+}
+
+// zones are traced as well, for looking at single frames after the fact
+Profiler::ScopedTimer::ScopedTimer(Zone zone) : zone(zone), start(SDL_GetPerformanceCounter()) {
+    Tracer::Instance().begin(getZoneName(zone));
+}
+
+Profiler::ScopedTimer::~ScopedTimer() {
+    Profiler::Instance().record(zone, start, SDL_GetPerformanceCounter());
+    Tracer::Instance().end(getZoneName(zone));
+}
+
+const char * Profiler::getZoneName(Zone zone) {
+    return ZONE_NAMES[static_cast<size_t>(zone)];
+}
+
+void Profiler::record(Zone zone, Uint64 start, Uint64 end) {
+    size_t idx { writeIndex.fetch_add(1, std::memory_order_relaxed) };
+    size_t slot { idx % RING_SIZE };
+
+    samples[slot] = { zone, end - start };
+    sampleSequences[slot].store(idx + 1, std::memory_order_release);
+}
+
+void Profiler::beginFrame() {
+    frameStart = SDL_GetPerformanceCounter();
+}
+
+void Profiler::endFrame() {
+    FrameTimes frame;
+    frame.frameMS = frameStart > 0 ? toMS(SDL_GetPerformanceCounter() - frameStart) : 0.0;
+
+    // samples overwritten before being read are dropped
+    size_t end { writeIndex.load(std::memory_order_acquire) };
+    if(end - readIndex > RING_SIZE) {
+        readIndex = end - RING_SIZE;
+    }
+
+    for(; readIndex < end; readIndex++) {
+        size_t slot { readIndex % RING_SIZE };
+
+        // a producer that hasn't finished writing its slot yet is picked up next frame
+        if(sampleSequences[slot].load(std::memory_order_acquire) != readIndex + 1) {
+            break;
+        }
+
+        const auto & sample = samples[slot];
+        frame.zoneMS[static_cast<size_t>(sample.zone)] += toMS(sample.duration);
+    }
+
+    history[historyIndex] = frame;
+    historyIndex = (historyIndex + 1) % HISTORY_FRAMES;
+    historyFrames = std::min(historyFrames + 1, HISTORY_FRAMES);
+}
+
+void Profiler::setShowOverlay(bool showOverlay) {
+    overlayShown = showOverlay;
+}
+
+bool Profiler::isOverlayShown() const {
+    return overlayShown;
+}
+
+void Profiler::showOverlay() {
+    if(!overlayShown) {
+        return;
+    }
+
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if(!ImGui::Begin("Profiler", &overlayShown, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        ImGui::End();
+        return;
+    }
+
+    // oldest frame first
+    std::vector<float> frameGraph;
+    std::vector<double> frameTimes;
+    size_t worstFrame { 0 };
+    for(size_t i = 0; i < historyFrames; i++) {
+        size_t idx { (historyIndex + HISTORY_FRAMES - historyFrames + i) % HISTORY_FRAMES };
+        frameGraph.push_back(static_cast<float>(history[idx].frameMS));
+        frameTimes.push_back(history[idx].frameMS);
+
+        if(history[idx].frameMS > history[worstFrame].frameMS) {
+            worstFrame = idx;
+        }
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    float graphMax { frameGraph.empty() ? 0.f : *std::max_element(frameGraph.begin(), frameGraph.end()) };
+    ImGui::PlotLines("##frametimes", frameGraph.data(), static_cast<int>(frameGraph.size()), 0, "Frame time (ms)",
+        0.f, std::max(graphMax, 1000.f / 60.f), ImVec2(360.f, 80.f));
+
+    ImGui::Text("Frame  p50 %.2f ms  p95 %.2f ms  p99 %.2f ms", percentile(frameTimes, 0.5), percentile(frameTimes, 0.95), percentile(frameTimes, 0.99));
+
+    // zones ordered by their slowest frame
+    struct ZoneStats {
+        size_t zone;
+        double average;
+        double p95;
+        double max;
+    };
+
+    std::vector<ZoneStats> zoneStats;
+    for(size_t zone = 0; zone < ZONE_NAMES.size(); zone++) {
+        std::vector<double> zoneTimes;
+        for(size_t i = 0; i < historyFrames; i++) {
+            zoneTimes.push_back(history[(historyIndex + HISTORY_FRAMES - historyFrames + i) % HISTORY_FRAMES].zoneMS[zone]);
+        }
+
+        std::sort(zoneTimes.begin(), zoneTimes.end());
+        double average { zoneTimes.empty() ? 0.0 : std::accumulate(zoneTimes.begin(), zoneTimes.end(), 0.0) / zoneTimes.size() };
+        zoneStats.push_back({ zone, average, percentile(zoneTimes, 0.95), zoneTimes.empty() ? 0.0 : zoneTimes.back() });
+    }
+
+    std::sort(zoneStats.begin(), zoneStats.end(), [](const ZoneStats & lhs, const ZoneStats & rhs) { return lhs.max > rhs.max; });
+
+    if(ImGui::BeginTable("zones", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Avg (ms)");
+        ImGui::TableSetupColumn("p95 (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+
+        for(const auto & stats : zoneStats) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(getZoneName(static_cast<Zone>(stats.zone)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.average);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p95);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.max);
+        }
+
+        ImGui::EndTable();
+    }
+
+    if(historyFrames > 0) {
+        const auto & worst = history[worstFrame];
+        auto worstZone { std::max_element(worst.zoneMS.begin(), worst.zoneMS.end()) - worst.zoneMS.begin() };
+        ImGui::Text("Worst frame %.2f ms, %.2f ms in %s", worst.frameMS, worst.zoneMS[worstZone], getZoneName(static_cast<Zone>(worstZone)));
+    }
+
+    ImGui::End();
+}
+
+#endif // TYPECHART_PROFILER
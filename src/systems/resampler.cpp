@@ -0,0 +1,178 @@
+#include "systems/resampler.hpp"
+#include "systems/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double PI { 3.14159265358979323846 };
+
+    // zeroth order modified Bessel function of the first kind, for the Kaiser window
+    double besselI0(double x) {
+        double sum { 1.0 };
+        double term { 1.0 };
+
+        for(int k = 1; k < 32; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+
+            if(term < sum * 1e-12) {
+                break;
+            }
+        }
+
+        return sum;
+    }
+}
+
+void Resampler::reset(int channels, int inRate, int outRate) {
+    this->channels = std::max(1, channels);
+    step = static_cast<double>(inRate) / static_cast<double>(std::max(1, outRate));
+
+    // when downsampling, the filter also has to remove what the output rate can't hold
+    double cutoff { 0.5 * CUTOFF * std::min(1.0, 1.0 / step) };
+    double windowNorm { besselI0(KAISER_BETA) };
+
+    kernels.resize(static_cast<std::size_t>((PHASES + 1) * TAPS));
+    for(int phase = 0; phase <= PHASES; phase++) {
+        double frac { static_cast<double>(phase) / PHASES };
+        float * coeffs { kernels.data() + phase * TAPS };
+        double sum { 0.0 };
+
+        for(int k = 0; k < TAPS; k++) {
+            double x { k - HALF_TAPS + 1 - frac };
+            double ratio { x / HALF_TAPS };
+            double window { ratio * ratio < 1.0 ? besselI0(KAISER_BETA * std::sqrt(1.0 - ratio * ratio)) / windowNorm : 0.0 };
+            double sinc { x == 0.0 ? 1.0 : std::sin(2.0 * PI * cutoff * x) / (2.0 * PI * cutoff * x) };
+
+            coeffs[k] = static_cast<float>(window * sinc);
+            sum += coeffs[k];
+        }
+
+        // unity gain at DC for every phase
+        for(int k = 0; k < TAPS; k++) {
+            coeffs[k] = static_cast<float>(coeffs[k] / sum);
+        }
+    }
+
+    kernelDeltas.resize(static_cast<std::size_t>(PHASES * TAPS));
+    for(int i = 0; i < PHASES * TAPS; i++) {
+        kernelDeltas[i] = kernels[i + TAPS] - kernels[i];
+    }
+
+    kernel.resize(TAPS);
+
+    // start with silence before the first frame, so output frame 0 lines up with input frame 0
+    history.assign(this->channels, std::vector<float>(HALF_TAPS - 1, 0.f));
+    historyStart = -(HALF_TAPS - 1);
+    inputFrames = 0;
+
+    time = 0.0;
+    output.clear();
+    finished = false;
+}
+
+void Resampler::pushInput(const float * samples, std::size_t numFrames) {
+    if(finished || numFrames == 0) {
+        return;
+    }
+
+    appendInput(samples, numFrames);
+    inputFrames += static_cast<std::int64_t>(numFrames);
+
+    process();
+}
+
+void Resampler::finish() {
+    if(finished) {
+        return;
+    }
+
+    finished = true;
+
+    // pad with silence so the filter reaches past the last frame
+    std::vector<float> silence(static_cast<std::size_t>(HALF_TAPS * channels), 0.f);
+    appendInput(silence.data(), HALF_TAPS);
+
+    process();
+}
+
+bool Resampler::isFinished() const {
+    return finished;
+}
+
+std::size_t Resampler::getOutputFrames() const {
+    return output.size() / channels;
+}
+
+std::size_t Resampler::pullOutput(float * samples, std::size_t maxFrames) {
+    std::size_t numFrames { std::min(maxFrames, getOutputFrames()) };
+
+    std::copy_n(output.begin(), numFrames * channels, samples);
+    output.erase(output.begin(), output.begin() + numFrames * channels);
+
+    return numFrames;
+}
+
+std::size_t Resampler::getMemoryUsage() const {
+    std::size_t floats { kernels.capacity() + kernelDeltas.capacity() + kernel.capacity() + output.capacity() };
+    for(const auto & channel : history) {
+        floats += channel.capacity();
+    }
+
+    return floats * sizeof(float) + history.capacity() * sizeof(std::vector<float>);
+}
+
+void Resampler::appendInput(const float * samples, std::size_t numFrames) {
+    for(int c = 0; c < channels; c++) {
+        auto & channel { history[c] };
+        std::size_t offset { channel.size() };
+
+        channel.resize(offset + numFrames);
+        for(std::size_t i = 0; i < numFrames; i++) {
+            channel[offset + i] = samples[i * channels + c];
+        }
+    }
+}
+
+void Resampler::process() {
+    std::int64_t historyEnd { historyStart + static_cast<std::int64_t>(history[0].size()) };
+
+    while(true) {
+        auto frame { static_cast<std::int64_t>(std::floor(time)) };
+
+        // everything past the end of the input has been produced
+        if(finished && time >= static_cast<double>(inputFrames)) {
+            break;
+        }
+
+        if(frame + HALF_TAPS >= historyEnd) {
+            break;
+        }
+
+        double phasePosition { (time - frame) * PHASES };
+        auto phase { std::min(static_cast<int>(phasePosition), PHASES - 1) };
+        auto frac { static_cast<float>(phasePosition - phase) };
+
+        std::copy_n(kernels.data() + phase * TAPS, TAPS, kernel.data());
+        simd::mixAdd(kernel.data(), kernelDeltas.data() + phase * TAPS, TAPS, frac);
+
+        auto first { static_cast<std::size_t>(frame - HALF_TAPS + 1 - historyStart) };
+        for(int c = 0; c < channels; c++) {
+            output.push_back(simd::dotProduct(kernel.data(), history[c].data() + first, TAPS));
+        }
+
+        time += step;
+    }
+
+    // drop input no later output frame reaches back to
+    auto keepFrom { static_cast<std::int64_t>(std::floor(time)) - HALF_TAPS + 1 };
+    if(keepFrom > historyStart) {
+        auto numDropped { static_cast<std::size_t>(std::min(keepFrom, historyEnd) - historyStart) };
+        for(auto & channel : history) {
+            channel.erase(channel.begin(), channel.begin() + numDropped);
+        }
+
+        historyStart += static_cast<std::int64_t>(numDropped);
+    }
+}
@@ -0,0 +1,360 @@
+#include "systems/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(TYPECHART_SIMD_SSE2)
+    #include <emmintrin.h>
+#elif defined(TYPECHART_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+namespace simd {
+    void minMax(const float * samples, std::size_t count, float & minOut, float & maxOut) {
+        float currMin { minOut };
+        float currMax { maxOut };
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            if(count >= 4) {
+                __m128 vMin { _mm_set1_ps(currMin) };
+                __m128 vMax { _mm_set1_ps(currMax) };
+
+                for(; i + 4 <= count; i += 4) {
+                    __m128 v { _mm_loadu_ps(samples + i) };
+                    vMin = _mm_min_ps(vMin, v);
+                    vMax = _mm_max_ps(vMax, v);
+                }
+
+                alignas(16) float mins[4];
+                alignas(16) float maxs[4];
+                _mm_store_ps(mins, vMin);
+                _mm_store_ps(maxs, vMax);
+
+                currMin = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+                currMax = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            if(count >= 4) {
+                float32x4_t vMin { vdupq_n_f32(currMin) };
+                float32x4_t vMax { vdupq_n_f32(currMax) };
+
+                for(; i + 4 <= count; i += 4) {
+                    float32x4_t v { vld1q_f32(samples + i) };
+                    vMin = vminq_f32(vMin, v);
+                    vMax = vmaxq_f32(vMax, v);
+                }
+
+                float32x2_t pMin { vpmin_f32(vget_low_f32(vMin), vget_high_f32(vMin)) };
+                float32x2_t pMax { vpmax_f32(vget_low_f32(vMax), vget_high_f32(vMax)) };
+                pMin = vpmin_f32(pMin, pMin);
+                pMax = vpmax_f32(pMax, pMax);
+
+                currMin = vget_lane_f32(pMin, 0);
+                currMax = vget_lane_f32(pMax, 0);
+            }
+        #endif
+
+        for(; i < count; i++) {
+            currMin = std::min(currMin, samples[i]);
+            currMax = std::max(currMax, samples[i]);
+        }
+
+        minOut = currMin;
+        maxOut = currMax;
+    }
+
+    void logCompress(float * values, std::size_t count, float scale) {
+        std::size_t i { 0 };
+
+        // ln(y) = e * ln(2) + ln(m), with ln(m) = 2 * atanh((m - 1) / (m + 1)) as a short odd series
+        #if defined(TYPECHART_SIMD_SSE2)
+            const __m128 vScale { _mm_set1_ps(scale) };
+            const __m128 vOne { _mm_set1_ps(1.f) };
+            const __m128 vLn2 { _mm_set1_ps(0.69314718f) };
+            const __m128i vMantissaMask { _mm_set1_epi32(0x007FFFFF) };
+            const __m128i vExponentOne { _mm_set1_epi32(0x3F800000) };
+            const __m128i vExponentBias { _mm_set1_epi32(127) };
+
+            for(; i + 4 <= count; i += 4) {
+                __m128 y { _mm_add_ps(vOne, _mm_mul_ps(vScale, _mm_loadu_ps(values + i))) };
+                __m128i bits { _mm_castps_si128(y) };
+
+                __m128 exponent { _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), vExponentBias)) };
+                __m128 mantissa { _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, vMantissaMask), vExponentOne)) };
+
+                __m128 t { _mm_div_ps(_mm_sub_ps(mantissa, vOne), _mm_add_ps(mantissa, vOne)) };
+                __m128 t2 { _mm_mul_ps(t, t) };
+                __m128 series { _mm_add_ps(_mm_set1_ps(1.f / 5.f), _mm_mul_ps(t2, _mm_set1_ps(1.f / 7.f))) };
+                series = _mm_add_ps(_mm_set1_ps(1.f / 3.f), _mm_mul_ps(t2, series));
+                series = _mm_add_ps(vOne, _mm_mul_ps(t2, series));
+
+                __m128 lnMantissa { _mm_mul_ps(_mm_set1_ps(2.f), _mm_mul_ps(t, series)) };
+                _mm_storeu_ps(values + i, _mm_add_ps(_mm_mul_ps(exponent, vLn2), lnMantissa));
+            }
+        #elif defined(TYPECHART_SIMD_NEON) && defined(__aarch64__)
+            const float32x4_t vScale { vdupq_n_f32(scale) };
+            const float32x4_t vOne { vdupq_n_f32(1.f) };
+            const float32x4_t vLn2 { vdupq_n_f32(0.69314718f) };
+            const uint32x4_t vMantissaMask { vdupq_n_u32(0x007FFFFF) };
+            const uint32x4_t vExponentOne { vdupq_n_u32(0x3F800000) };
+            const int32x4_t vExponentBias { vdupq_n_s32(127) };
+
+            for(; i + 4 <= count; i += 4) {
+                float32x4_t y { vaddq_f32(vOne, vmulq_f32(vScale, vld1q_f32(values + i))) };
+                uint32x4_t bits { vreinterpretq_u32_f32(y) };
+
+                float32x4_t exponent { vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vExponentBias)) };
+                float32x4_t mantissa { vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vMantissaMask), vExponentOne)) };
+
+                float32x4_t t { vdivq_f32(vsubq_f32(mantissa, vOne), vaddq_f32(mantissa, vOne)) };
+                float32x4_t t2 { vmulq_f32(t, t) };
+                float32x4_t series { vmlaq_f32(vdupq_n_f32(1.f / 5.f), t2, vdupq_n_f32(1.f / 7.f)) };
+                series = vmlaq_f32(vdupq_n_f32(1.f / 3.f), t2, series);
+                series = vmlaq_f32(vOne, t2, series);
+
+                float32x4_t lnMantissa { vmulq_f32(vdupq_n_f32(2.f), vmulq_f32(t, series)) };
+                vst1q_f32(values + i, vmlaq_f32(lnMantissa, exponent, vLn2));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            values[i] = std::log1p(scale * values[i]);
+        }
+    }
+
+    float dotProduct(const float * a, const float * b, std::size_t count) {
+        float sum { 0.f };
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vSum { _mm_setzero_ps() };
+
+            for(; i + 4 <= count; i += 4) {
+                vSum = _mm_add_ps(vSum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            }
+
+            alignas(16) float sums[4];
+            _mm_store_ps(sums, vSum);
+            sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        #elif defined(TYPECHART_SIMD_NEON)
+            float32x4_t vSum { vdupq_n_f32(0.f) };
+
+            for(; i + 4 <= count; i += 4) {
+                vSum = vmlaq_f32(vSum, vld1q_f32(a + i), vld1q_f32(b + i));
+            }
+
+            float32x2_t pairSum { vadd_f32(vget_low_f32(vSum), vget_high_f32(vSum)) };
+            sum = vget_lane_f32(vpadd_f32(pairSum, pairSum), 0);
+        #endif
+
+        for(; i < count; i++) {
+            sum += a[i] * b[i];
+        }
+
+        return sum;
+    }
+
+    float positiveDifferenceSum(const float * curr, const float * prev, std::size_t count) {
+        float sum { 0.f };
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vSum { _mm_setzero_ps() };
+            __m128 vZero { _mm_setzero_ps() };
+
+            for(; i + 4 <= count; i += 4) {
+                __m128 diff { _mm_sub_ps(_mm_loadu_ps(curr + i), _mm_loadu_ps(prev + i)) };
+                vSum = _mm_add_ps(vSum, _mm_max_ps(diff, vZero));
+            }
+
+            alignas(16) float sums[4];
+            _mm_store_ps(sums, vSum);
+            sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        #elif defined(TYPECHART_SIMD_NEON)
+            float32x4_t vSum { vdupq_n_f32(0.f) };
+            float32x4_t vZero { vdupq_n_f32(0.f) };
+
+            for(; i + 4 <= count; i += 4) {
+                float32x4_t diff { vsubq_f32(vld1q_f32(curr + i), vld1q_f32(prev + i)) };
+                vSum = vaddq_f32(vSum, vmaxq_f32(diff, vZero));
+            }
+
+            float32x2_t pairSum { vadd_f32(vget_low_f32(vSum), vget_high_f32(vSum)) };
+            sum = vget_lane_f32(vpadd_f32(pairSum, pairSum), 0);
+        #endif
+
+        for(; i < count; i++) {
+            sum += std::max(curr[i] - prev[i], 0.f);
+        }
+
+        return sum;
+    }
+
+    void mixAdd(float * dst, const float * src, std::size_t count, float gain) {
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vGain { _mm_set1_ps(gain) };
+
+            for(; i + 4 <= count; i += 4) {
+                __m128 mixed { _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(vGain, _mm_loadu_ps(src + i))) };
+                _mm_storeu_ps(dst + i, mixed);
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            float32x4_t vGain { vdupq_n_f32(gain) };
+
+            for(; i + 4 <= count; i += 4) {
+                vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vGain, vld1q_f32(src + i)));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            dst[i] += gain * src[i];
+        }
+    }
+
+    void multiplyAdd(float * dst, const float * a, const float * b, std::size_t count) {
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            for(; i + 4 <= count; i += 4) {
+                __m128 mixed { _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))) };
+                _mm_storeu_ps(dst + i, mixed);
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            for(; i + 4 <= count; i += 4) {
+                vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(a + i), vld1q_f32(b + i)));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            dst[i] += a[i] * b[i];
+        }
+    }
+
+    void int16ToFloat(float * dst, const std::int16_t * src, std::size_t count) {
+        constexpr float scale { 1.f / 32768.f };
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vScale { _mm_set1_ps(scale) };
+
+            for(; i + 8 <= count; i += 8) {
+                __m128i v { _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)) };
+
+                // sign extend by placing each sample in the high half, then shifting down
+                __m128i lo { _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16) };
+                __m128i hi { _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16) };
+
+                _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vScale));
+                _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vScale));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            for(; i + 8 <= count; i += 8) {
+                int16x8_t v { vld1q_s16(src + i) };
+
+                vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+                vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            dst[i] = static_cast<float>(src[i]) * scale;
+        }
+    }
+
+    void int32ToFloat(float * dst, const std::int32_t * src, std::size_t count) {
+        constexpr float scale { 1.f / 2147483648.f };
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vScale { _mm_set1_ps(scale) };
+
+            for(; i + 4 <= count; i += 4) {
+                __m128i v { _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)) };
+                _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), vScale));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            for(; i + 4 <= count; i += 4) {
+                vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            dst[i] = static_cast<float>(src[i]) * scale;
+        }
+    }
+
+    void floatToInt16(std::int16_t * dst, const float * src, std::size_t count) {
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            __m128 vScale { _mm_set1_ps(32767.f) };
+
+            for(; i + 8 <= count; i += 8) {
+                // cvtps rounds to nearest, packs saturates to the 16-bit range
+                __m128i lo { _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), vScale)) };
+                __m128i hi { _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), vScale)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo, hi));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            // vcvtq truncates toward zero; round to nearest like the other paths
+            auto roundToInt32 { [](float32x4_t v) {
+                #if defined(__aarch64__)
+                    return vcvtnq_s32_f32(v);
+                #else
+                    uint32x4_t negative { vcltq_f32(v, vdupq_n_f32(0.f)) };
+                    return vcvtq_s32_f32(vaddq_f32(v, vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f))));
+                #endif
+            } };
+
+            for(; i + 8 <= count; i += 8) {
+                int32x4_t lo { roundToInt32(vmulq_n_f32(vld1q_f32(src + i), 32767.f)) };
+                int32x4_t hi { roundToInt32(vmulq_n_f32(vld1q_f32(src + i + 4), 32767.f)) };
+                vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+            }
+        #endif
+
+        for(; i < count; i++) {
+            float sample { std::clamp(src[i], -1.f, 1.f) * 32767.f };
+            dst[i] = static_cast<std::int16_t>(std::lround(sample));
+        }
+    }
+
+    void monoToStereo(float * dst, const float * src, std::size_t numFrames) {
+        std::size_t i { 0 };
+
+        #if defined(TYPECHART_SIMD_SSE2)
+            for(; i + 4 <= numFrames; i += 4) {
+                __m128 v { _mm_loadu_ps(src + i) };
+                _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(v, v));
+                _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(v, v));
+            }
+        #elif defined(TYPECHART_SIMD_NEON)
+            for(; i + 4 <= numFrames; i += 4) {
+                float32x4_t v { vld1q_f32(src + i) };
+                float32x4x2_t pair { { v, v } };
+                vst2q_f32(dst + i * 2, pair);
+            }
+        #endif
+
+        for(; i < numFrames; i++) {
+            dst[i * 2] = src[i];
+            dst[i * 2 + 1] = src[i];
+        }
+    }
+
+    void downmixToStereo(float * dst, const float * src, std::size_t numFrames, int channels,
+        const float * leftWeights, const float * rightWeights)
+    {
+        auto numChannels { static_cast<std::size_t>(channels) };
+
+        for(std::size_t frame = 0; frame < numFrames; frame++) {
+            // each frame is a short dot product against both weight rows
+            const float * samples { src + frame * numChannels };
+            dst[frame * 2] = dotProduct(samples, leftWeights, numChannels);
+            dst[frame * 2 + 1] = dotProduct(samples, rightWeights, numChannels);
+        }
+    }
+}
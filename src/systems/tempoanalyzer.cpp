@@ -0,0 +1,419 @@
+#include "systems/tempoanalyzer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "systems/fft.hpp"
+#include "systems/simd.hpp"
+#include "systems/tracer.hpp"
+
+namespace {
+    // onsets only need a coarse spectrum, so analyze a decimated mono mixdown
+    constexpr int TARGET_ANALYSIS_RATE { 11025 };
+    constexpr size_t FFT_SIZE { 512 };
+    constexpr size_t HOP_SIZE { 128 };
+    constexpr sf_count_t DECODE_CHUNK_FRAMES { 16384 };
+
+    constexpr float LOG_COMPRESSION { 10.f };
+    constexpr size_t LOCAL_MEAN_RADIUS { 16 };
+    constexpr double MIN_ANALYSIS_SECONDS { 4.0 };
+
+    constexpr double MIN_BPM { 60.0 };
+    constexpr double MAX_BPM { 200.0 };
+    constexpr double PREFERRED_BPM { 120.0 };
+    constexpr double PREFERRED_BPM_OCTAVES { 1.0 };
+    constexpr double BPM_REFINE_STEP { 0.01 };
+    constexpr double BPM_SNAP_TOLERANCE { 0.05 };
+
+    constexpr size_t PHASE_BINS { 32 };
+
+    constexpr double WINDOW_SECONDS { 10.0 };
+    constexpr double WINDOW_HOP_SECONDS { 5.0 };
+    constexpr double MIN_WINDOW_STRENGTH { 0.15 };
+    constexpr double TEMPO_CHANGE_TOLERANCE { 0.02 };
+
+    double snapBpm(double bpm) {
+        double rounded { std::round(bpm) };
+        if(std::abs(bpm - rounded) < BPM_SNAP_TOLERANCE) {
+            return rounded;
+        }
+
+        return std::round(bpm * 100.0) / 100.0;
+    }
+
+    // tempos an octave apart describe the same beat grid
+    bool isSameTempo(double bpm, double otherBpm) {
+        for(double ratio : { 1.0, 2.0, 0.5 }) {
+            if(std::abs(bpm * ratio - otherBpm) / otherBpm < TEMPO_CHANGE_TOLERANCE) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+TempoAnalyzer::~TempoAnalyzer() {
+    stop();
+}
+
+bool TempoAnalyzer::start(const fs::path & musicPath) {
+    stop();
+
+    estimate = TempoEstimate();
+    onsetEnvelope.clear();
+    progress = 0.f;
+    finished = false;
+    failed = false;
+    stopAnalysis = false;
+
+    SF_INFO sfinfo {};
+    SNDFILE * sndfile = sf_open(musicPath.string().c_str(), SFM_READ, &sfinfo);
+    if(!sndfile) {
+        failed = true;
+        return false;
+    }
+
+    if(sfinfo.frames <= 0 || sfinfo.channels <= 0 || sfinfo.samplerate <= 0) {
+        sf_close(sndfile);
+        failed = true;
+        return false;
+    }
+
+    analysisThread = std::thread(&TempoAnalyzer::analyze, this, sndfile, sfinfo);
+    return true;
+}
+
+void TempoAnalyzer::stop() {
+    stopAnalysis = true;
+    if(analysisThread.joinable()) {
+        analysisThread.join();
+    }
+}
+
+bool TempoAnalyzer::isRunning() const {
+    return analysisThread.joinable() && !finished && !failed;
+}
+
+bool TempoAnalyzer::isFinished() const {
+    return finished;
+}
+
+bool TempoAnalyzer::hasFailed() const {
+    return failed;
+}
+
+float TempoAnalyzer::getProgress() const {
+    return progress;
+}
+
+const TempoAnalyzer::TempoEstimate & TempoAnalyzer::getEstimate() const {
+    return estimate;
+}
+
+void TempoAnalyzer::analyze(SNDFILE * sndfile, SF_INFO sfinfo) {
+    TRACE_THREAD_NAME("Tempo analysis");
+    TRACE_SCOPE("Analyze tempo");
+
+    bool decoded { computeOnsetEnvelope(sndfile, sfinfo) };
+    sf_close(sndfile);
+
+    if(stopAnalysis) {
+        return;
+    }
+
+    double envelopeRate { analysisRate / HOP_SIZE };
+    if(!decoded || onsetEnvelope.size() < static_cast<size_t>(MIN_ANALYSIS_SECONDS * envelopeRate)) {
+        failed = true;
+        return;
+    }
+
+    auto segments { findTempoSegments() };
+    progress = 0.9f;
+
+    for(size_t i = 0; i < segments.size() && !stopAnalysis; i++) {
+        const auto & segment { segments.at(i) };
+
+        // refine each constant tempo stretch over its whole length, then rescore the
+        // snapped tempo so the phase matches the suggested bpm
+        BeatGrid grid { estimateBeatGrid(segment.first, segment.last, 60.0 * envelopeRate / (segment.bpm * (1.0 + TEMPO_CHANGE_TOLERANCE)),
+            60.0 * envelopeRate / (segment.bpm * (1.0 - TEMPO_CHANGE_TOLERANCE))) };
+        if(grid.period <= 0.0) {
+            grid.period = 60.0 * envelopeRate / segment.bpm;
+        }
+
+        double bpm { snapBpm(periodToBpm(grid.period)) };
+        grid = scorePeriod(segment.first, segment.last, 60.0 * envelopeRate / bpm);
+
+        if(i == 0) {
+            double beatSecs { 60.0 / bpm };
+            double baseline { 3.0 / PHASE_BINS };
+
+            estimate.bpm = bpm;
+            estimate.offsetMS = static_cast<int>(std::round(std::fmod(frameToTime(grid.phase), beatSecs) * 1000.0));
+            estimate.confidence = std::clamp((grid.strength - baseline) / (1.0 - baseline), 0.0, 1.0);
+        } else {
+            estimate.tempoChanges.push_back({ frameToTime(static_cast<double>(segment.first)), bpm });
+        }
+    }
+
+    if(estimate.bpm <= 0.0) {
+        failed = true;
+        return;
+    }
+
+    progress = 1.f;
+    finished = true;
+}
+
+bool TempoAnalyzer::computeOnsetEnvelope(SNDFILE * sndfile, const SF_INFO & sfinfo) {
+    int decimation { std::max(1, sfinfo.samplerate / TARGET_ANALYSIS_RATE) };
+    analysisRate = static_cast<double>(sfinfo.samplerate) / decimation;
+
+    FFT fft { FFT_SIZE };
+    std::vector<float> magnitudes(fft.getNumBins());
+    std::vector<float> prevMagnitudes(fft.getNumBins(), 0.f);
+
+    std::vector<float> chunk(static_cast<size_t>(DECODE_CHUNK_FRAMES * sfinfo.channels));
+    std::vector<float> pending;
+    pending.reserve(FFT_SIZE + DECODE_CHUNK_FRAMES);
+
+    std::vector<float> rawFlux;
+    rawFlux.reserve(static_cast<size_t>(sfinfo.frames / decimation / HOP_SIZE + 1));
+
+    float decimationSum { 0.f };
+    int decimationCount { 0 };
+    float mixScale { 1.f / static_cast<float>(decimation * sfinfo.channels) };
+
+    sf_count_t framesRead { 0 };
+    while(!stopAnalysis) {
+        sf_count_t readCount { sf_readf_float(sndfile, chunk.data(), DECODE_CHUNK_FRAMES) };
+        if(readCount <= 0) {
+            break;
+        }
+
+        // mono mixdown + box-filter decimation
+        for(sf_count_t frame = 0; frame < readCount; frame++) {
+            const float * samples { chunk.data() + frame * sfinfo.channels };
+            for(int channel = 0; channel < sfinfo.channels; channel++) {
+                decimationSum += samples[channel];
+            }
+
+            if(++decimationCount == decimation) {
+                pending.push_back(decimationSum * mixScale);
+                decimationSum = 0.f;
+                decimationCount = 0;
+            }
+        }
+
+        size_t consumed { 0 };
+        for(; consumed + FFT_SIZE <= pending.size(); consumed += HOP_SIZE) {
+            fft.magnitudes(pending.data() + consumed, magnitudes.data());
+            simd::logCompress(magnitudes.data(), magnitudes.size(), LOG_COMPRESSION);
+
+            rawFlux.push_back(rawFlux.empty() ? 0.f : simd::positiveDifferenceSum(magnitudes.data(), prevMagnitudes.data(), magnitudes.size()));
+            std::swap(magnitudes, prevMagnitudes);
+        }
+
+        pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+        framesRead += readCount;
+        progress = 0.8f * static_cast<float>(std::min(1.0, static_cast<double>(framesRead) / sfinfo.frames));
+    }
+
+    if(stopAnalysis || rawFlux.empty()) {
+        return false;
+    }
+
+    // subtract the local mean so sustained loudness doesn't read as onsets
+    std::vector<double> prefixSums(rawFlux.size() + 1, 0.0);
+    for(size_t i = 0; i < rawFlux.size(); i++) {
+        prefixSums[i + 1] = prefixSums[i] + rawFlux[i];
+    }
+
+    onsetEnvelope.resize(rawFlux.size());
+    for(size_t i = 0; i < rawFlux.size(); i++) {
+        size_t first { i > LOCAL_MEAN_RADIUS ? i - LOCAL_MEAN_RADIUS : 0 };
+        size_t last { std::min(rawFlux.size(), i + LOCAL_MEAN_RADIUS + 1) };
+        double localMean { (prefixSums[last] - prefixSums[first]) / static_cast<double>(last - first) };
+
+        onsetEnvelope[i] = std::max(0.f, rawFlux[i] - static_cast<float>(localMean));
+    }
+
+    return true;
+}
+
+TempoAnalyzer::BeatGrid TempoAnalyzer::estimateBeatGrid(size_t first, size_t last, double minPeriod, double maxPeriod) const {
+    double coarsePeriod { findAutocorrelationPeriod(first, last, minPeriod, maxPeriod) };
+    if(coarsePeriod <= 0.0) {
+        return BeatGrid();
+    }
+
+    // the autocorrelation lag is only frame accurate, refine on a fine bpm grid around it
+    double lowBpm { std::max(MIN_BPM, periodToBpm(coarsePeriod + 1.0)) };
+    double highBpm { std::min(MAX_BPM, periodToBpm(std::max(1.0, coarsePeriod - 1.0))) };
+    double envelopeRate { analysisRate / HOP_SIZE };
+
+    BeatGrid bestGrid;
+    for(double bpm = lowBpm; bpm <= highBpm; bpm += BPM_REFINE_STEP) {
+        BeatGrid grid { scorePeriod(first, last, 60.0 * envelopeRate / bpm) };
+        if(grid.strength > bestGrid.strength) {
+            bestGrid = grid;
+        }
+    }
+
+    return bestGrid;
+}
+
+double TempoAnalyzer::findAutocorrelationPeriod(size_t first, size_t last, double minPeriod, double maxPeriod) const {
+    auto minLag { static_cast<size_t>(std::floor(minPeriod)) };
+    auto maxLag { static_cast<size_t>(std::ceil(maxPeriod)) };
+    size_t count { last - first };
+    if(minLag < 1 || count <= maxLag * 2) {
+        return 0.0;
+    }
+
+    double preferredLag { 60.0 * (analysisRate / HOP_SIZE) / PREFERRED_BPM };
+    const float * envelope { onsetEnvelope.data() + first };
+
+    // autocorrelation weighted towards common tempos to settle octave ambiguity
+    std::vector<double> weighted(maxLag + 2, 0.0);
+    for(size_t lag = minLag; lag <= maxLag + 1; lag++) {
+        double correlation { simd::dotProduct(envelope, envelope + lag, count - lag) / static_cast<double>(count - lag) };
+        double octaves { std::log2(lag / preferredLag) / PREFERRED_BPM_OCTAVES };
+        weighted[lag] = correlation * std::exp(-0.5 * octaves * octaves);
+    }
+
+    size_t bestLag { minLag };
+    for(size_t lag = minLag; lag <= maxLag; lag++) {
+        if(weighted[lag] > weighted[bestLag]) {
+            bestLag = lag;
+        }
+    }
+
+    if(weighted[bestLag] <= 0.0) {
+        return 0.0;
+    }
+
+    // parabolic interpolation between neighbouring lags
+    double period { static_cast<double>(bestLag) };
+    if(bestLag > minLag) {
+        double prev { weighted[bestLag - 1] };
+        double curr { weighted[bestLag] };
+        double next { weighted[bestLag + 1] };
+        double denom { prev - 2.0 * curr + next };
+
+        if(std::abs(denom) > 1e-12) {
+            period += std::clamp(0.5 * (prev - next) / denom, -0.5, 0.5);
+        }
+    }
+
+    return period;
+}
+
+TempoAnalyzer::BeatGrid TempoAnalyzer::scorePeriod(size_t first, size_t last, double period) const {
+    // fold the envelope onto one beat period; a correct tempo piles the onsets into few phase bins
+    std::array<double, PHASE_BINS> phaseBins {};
+    double total { 0.0 };
+    double binsPerFrame { PHASE_BINS / period };
+
+    for(size_t i = first; i < last; i++) {
+        double beatPosition { (i - first) / period };
+        auto bin { static_cast<size_t>((beatPosition - std::floor(beatPosition)) * PHASE_BINS) % PHASE_BINS };
+
+        phaseBins[bin] += onsetEnvelope[i];
+        total += onsetEnvelope[i];
+    }
+
+    BeatGrid grid;
+    grid.period = period;
+    if(total <= 0.0) {
+        return grid;
+    }
+
+    size_t bestBin { 0 };
+    double bestSum { -1.0 };
+    for(size_t bin = 0; bin < PHASE_BINS; bin++) {
+        double binSum { phaseBins[(bin + PHASE_BINS - 1) % PHASE_BINS] + phaseBins[bin] + phaseBins[(bin + 1) % PHASE_BINS] };
+        if(binSum > bestSum) {
+            bestSum = binSum;
+            bestBin = bin;
+        }
+    }
+
+    double centroid { 0.0 };
+    if(bestSum > 0.0) {
+        centroid = (phaseBins[(bestBin + 1) % PHASE_BINS] - phaseBins[(bestBin + PHASE_BINS - 1) % PHASE_BINS]) / bestSum;
+    }
+
+    grid.phase = first + std::fmod((bestBin + 0.5 + centroid) / binsPerFrame + period, period);
+    grid.strength = bestSum / total;
+
+    return grid;
+}
+
+std::vector<TempoAnalyzer::TempoSegment> TempoAnalyzer::findTempoSegments() const {
+    double envelopeRate { analysisRate / HOP_SIZE };
+    double minPeriod { 60.0 * envelopeRate / MAX_BPM };
+    double maxPeriod { 60.0 * envelopeRate / MIN_BPM };
+
+    auto windowFrames { static_cast<size_t>(WINDOW_SECONDS * envelopeRate) };
+    auto hopFrames { static_cast<size_t>(WINDOW_HOP_SECONDS * envelopeRate) };
+
+    struct WindowTempo {
+        size_t start;
+        double bpm;
+    };
+
+    // local tempo over overlapping windows, skipping quiet or arrhythmic stretches
+    std::vector<WindowTempo> windowTempos;
+    for(size_t start = 0; start + windowFrames <= onsetEnvelope.size() && !stopAnalysis; start += hopFrames) {
+        auto coarsePeriod { findAutocorrelationPeriod(start, start + windowFrames, minPeriod, maxPeriod) };
+        if(coarsePeriod <= 0.0) {
+            continue;
+        }
+
+        BeatGrid grid { scorePeriod(start, start + windowFrames, coarsePeriod) };
+        if(grid.strength >= MIN_WINDOW_STRENGTH) {
+            windowTempos.push_back({ start, periodToBpm(coarsePeriod) });
+        }
+    }
+
+    std::vector<TempoSegment> segments;
+    if(windowTempos.empty()) {
+        // too short (or too irregular) for windowed analysis, use the whole song
+        double period { findAutocorrelationPeriod(0, onsetEnvelope.size(), minPeriod, maxPeriod) };
+        if(period > 0.0) {
+            segments.push_back({ 0, onsetEnvelope.size(), periodToBpm(period) });
+        }
+
+        return segments;
+    }
+
+    segments.push_back({ 0, onsetEnvelope.size(), windowTempos.front().bpm });
+
+    // a change has to hold for two consecutive windows to count
+    for(size_t i = 1; i + 1 < windowTempos.size(); i++) {
+        const auto & window { windowTempos.at(i) };
+        if(isSameTempo(window.bpm, segments.back().bpm) || !isSameTempo(window.bpm, windowTempos.at(i + 1).bpm)) {
+            continue;
+        }
+
+        // the previous (overlapping) window still matched, so the change is past its end
+        size_t changeFrame { std::min(window.start + hopFrames, onsetEnvelope.size()) };
+        segments.back().last = changeFrame;
+        segments.push_back({ changeFrame, onsetEnvelope.size(), window.bpm });
+    }
+
+    return segments;
+}
+
+double TempoAnalyzer::frameToTime(double frame) const {
+    // flux frames are reported at the centre of their analysis window
+    return (frame * HOP_SIZE + FFT_SIZE / 2.0) / analysisRate;
+}
+
+double TempoAnalyzer::periodToBpm(double period) const {
+    return 60.0 * (analysisRate / HOP_SIZE) / period;
+}
@@ -0,0 +1,203 @@
+#include "systems/timestretcher.hpp"
+#include "systems/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr double PI { 3.14159265358979323846 };
+}
+
+void TimeStretcher::reset(int channels, int samplerate, double rate) {
+    this->channels = std::max(1, channels);
+    this->rate = rate;
+
+    hopFrames = std::max<std::size_t>(1, static_cast<std::size_t>(samplerate * WINDOW_SECONDS / 2));
+    windowFrames = hopFrames * 2;
+    seekFrames = static_cast<std::int64_t>(samplerate * SEEK_SECONDS);
+
+    window.resize(windowFrames * this->channels);
+    for(std::size_t i = 0; i < windowFrames; i++) {
+        auto w { static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * static_cast<double>(i) / static_cast<double>(windowFrames))) };
+        std::fill_n(window.begin() + i * this->channels, this->channels, w);
+    }
+
+    input.clear();
+    mono.clear();
+    inputStart = 0;
+    inputEnd = 0;
+
+    overlap.assign(windowFrames * this->channels, 0.f);
+    output.clear();
+
+    numSegments = 0;
+    prevSegmentStart = 0;
+
+    finished = false;
+    drained = false;
+}
+
+void TimeStretcher::pushInput(const float * samples, std::size_t numFrames) {
+    if(finished || numFrames == 0) {
+        return;
+    }
+
+    appendInput(samples, numFrames);
+    while(processSegment());
+}
+
+void TimeStretcher::finish() {
+    if(finished) {
+        return;
+    }
+
+    finished = true;
+    inputEnd = inputStart + static_cast<std::int64_t>(mono.size());
+
+    // pad with silence so the last segments can still be matched and windowed
+    std::vector<float> silence((windowFrames + seekFrames) * channels, 0.f);
+    appendInput(silence.data(), windowFrames + seekFrames);
+
+    while(processSegment());
+}
+
+std::size_t TimeStretcher::getOutputFrames() const {
+    return output.size() / channels;
+}
+
+std::size_t TimeStretcher::pullOutput(float * samples, std::size_t maxFrames) {
+    std::size_t numFrames { std::min(maxFrames, getOutputFrames()) };
+
+    std::copy_n(output.begin(), numFrames * channels, samples);
+    output.erase(output.begin(), output.begin() + numFrames * channels);
+
+    return numFrames;
+}
+
+std::size_t TimeStretcher::getMemoryUsage() const {
+    return (window.capacity() + input.capacity() + mono.capacity() + overlap.capacity() + output.capacity()) * sizeof(float);
+}
+
+bool TimeStretcher::isFinished() const {
+    return finished;
+}
+
+bool TimeStretcher::processSegment() {
+    if(drained) {
+        return false;
+    }
+
+    std::int64_t nominalStart { getNominalStart(numSegments) };
+    if(finished && nominalStart >= inputEnd) {
+        drained = true;
+        return false;
+    }
+
+    if(inputStart + static_cast<std::int64_t>(mono.size()) < nominalStart + seekFrames + static_cast<std::int64_t>(windowFrames)) {
+        return false;
+    }
+
+    std::int64_t segmentStart { nominalStart };
+    std::size_t hopSamples { hopFrames * channels };
+
+    if(numSegments == 0) {
+        // act as if a previous segment faded out over the first hop, so playback doesn't fade in
+        for(std::size_t i = 0; i < hopSamples; i++) {
+            overlap[i] = input[i] * window[hopSamples + i];
+        }
+    } else {
+        segmentStart = findBestSegment(nominalStart);
+    }
+
+    simd::multiplyAdd(overlap.data(), window.data(), &input[(segmentStart - inputStart) * channels], windowFrames * channels);
+
+    // the first hop has now received both of its overlapping segments
+    output.insert(output.end(), overlap.begin(), overlap.begin() + hopSamples);
+    std::copy(overlap.begin() + hopSamples, overlap.end(), overlap.begin());
+    std::fill(overlap.end() - hopSamples, overlap.end(), 0.f);
+
+    prevSegmentStart = segmentStart;
+    numSegments++;
+
+    trimInput();
+
+    return true;
+}
+
+std::int64_t TimeStretcher::getNominalStart(std::int64_t segment) const {
+    // where the segment would start with no search, i.e. the output position scaled by the rate
+    return static_cast<std::int64_t>(std::llround(static_cast<double>(segment) * static_cast<double>(hopFrames) * rate));
+}
+
+std::int64_t TimeStretcher::findBestSegment(std::int64_t nominalStart) const {
+    // the best segment continues the previous one the way the input itself does
+    const float * target { &mono[prevSegmentStart + hopFrames - inputStart] };
+
+    std::int64_t minStart { std::max(inputStart, nominalStart - seekFrames) };
+    std::int64_t maxStart { nominalStart + seekFrames };
+
+    std::int64_t bestStart { std::max(minStart, nominalStart) };
+    float bestScore { -std::numeric_limits<float>::max() };
+
+    for(auto start = minStart; start <= maxStart; start += COARSE_SEEK_STEP) {
+        float score { scoreSegment(start, target) };
+        if(score > bestScore) {
+            bestScore = score;
+            bestStart = start;
+        }
+    }
+
+    std::int64_t coarseStart { bestStart };
+    std::int64_t fineMin { std::max(minStart, coarseStart - COARSE_SEEK_STEP + 1) };
+    std::int64_t fineMax { std::min(maxStart, coarseStart + COARSE_SEEK_STEP - 1) };
+
+    for(auto start = fineMin; start <= fineMax; start++) {
+        float score { scoreSegment(start, target) };
+        if(score > bestScore) {
+            bestScore = score;
+            bestStart = start;
+        }
+    }
+
+    return bestStart;
+}
+
+float TimeStretcher::scoreSegment(std::int64_t start, const float * target) const {
+    // normalized cross-correlation over the part that overlaps the previous segment
+    const float * candidate { &mono[start - inputStart] };
+    std::size_t overlapFrames { windowFrames - hopFrames };
+
+    float correlation { simd::dotProduct(candidate, target, overlapFrames) };
+    float energy { simd::dotProduct(candidate, candidate, overlapFrames) };
+
+    return correlation / std::sqrt(energy + 1e-9f);
+}
+
+void TimeStretcher::appendInput(const float * samples, std::size_t numFrames) {
+    input.insert(input.end(), samples, samples + numFrames * channels);
+
+    mono.reserve(mono.size() + numFrames);
+    for(std::size_t i = 0; i < numFrames; i++) {
+        float sum { 0.f };
+        for(int c = 0; c < channels; c++) {
+            sum += samples[i * channels + c];
+        }
+
+        mono.push_back(sum);
+    }
+}
+
+void TimeStretcher::trimInput() {
+    // keep what the next segment search and its match target can still reach
+    std::int64_t keepFrom { std::min(getNominalStart(numSegments) - seekFrames, prevSegmentStart + static_cast<std::int64_t>(hopFrames)) };
+
+    auto numTrimmed { keepFrom - inputStart };
+    if(numTrimmed < static_cast<std::int64_t>(windowFrames)) {
+        return;
+    }
+
+    input.erase(input.begin(), input.begin() + numTrimmed * channels);
+    mono.erase(mono.begin(), mono.begin() + numTrimmed);
+    inputStart = keepFrom;
+}
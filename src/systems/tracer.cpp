@@ -0,0 +1,153 @@
+#include "systems/tracer.hpp"
+
+#ifdef TYPECHART_PROFILER
+
+#include <algorithm>
+#include <fstream>
+
+// returns its thread's buffer to the tracer when the thread exits, so short-lived workers reuse buffers
+struct Tracer::ThreadHandle {
+    ThreadBuffer * buffer { nullptr };
+
+    ~ThreadHandle() {
+        if(buffer) {
+            buffer->inUse = false;
+        }
+    }
+};
+
+Tracer::ScopedEvent::ScopedEvent(const char * name) : name(name) {
+    Tracer::Instance().begin(name);
+}
+
+Tracer::ScopedEvent::~ScopedEvent() {
+    Tracer::Instance().end(name);
+}
+
+void Tracer::begin(const char * name) {
+    record(name, 'B');
+}
+
+void Tracer::end(const char * name) {
+    record(name, 'E');
+}
+
+void Tracer::counter(const char * name, int id, double value) {
+    record(name, 'C', id, value);
+}
+
+void Tracer::record(const char * name, char phase, int id, double value) {
+    if(!recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto & buffer { getThreadBuffer() };
+    Event event { name, SDL_GetPerformanceCounter(), buffer.tid, phase, id, value };
+
+    // the oldest events are overwritten once the buffer is full
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if(buffer.events.size() < EVENTS_PER_THREAD) {
+        buffer.events.push_back(event);
+    } else {
+        buffer.events[buffer.next] = event;
+    }
+
+    buffer.next = (buffer.next + 1) % EVENTS_PER_THREAD;
+}
+
+Tracer::ThreadBuffer & Tracer::getThreadBuffer() {
+    static thread_local ThreadHandle handle;
+    if(handle.buffer) {
+        return *handle.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    auto freeBuffer { std::find_if(buffers.begin(), buffers.end(), [](const auto & buffer) { return !buffer->inUse; }) };
+    if(freeBuffer == buffers.end()) {
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        freeBuffer = std::prev(buffers.end());
+    }
+
+    // a reused buffer keeps the finished thread's events under its old id
+    handle.buffer = freeBuffer->get();
+    handle.buffer->inUse = true;
+    handle.buffer->tid = nextTid++;
+
+    return *handle.buffer;
+}
+
+void Tracer::setThreadName(const std::string & name) {
+    auto tid { getThreadBuffer().tid };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    threadNames[tid] = name;
+}
+
+void Tracer::setRecording(bool recording) {
+    this->recording = recording;
+}
+
+bool Tracer::isRecording() const {
+    return recording;
+}
+
+bool Tracer::save(const fs::path & tracePath) {
+    std::vector<Event> events;
+    std::map<unsigned int, std::string> names;
+
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        names = threadNames;
+
+        for(const auto & buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+
+            // oldest first, so each thread's begin events precede their ends
+            bool wrapped { buffer->events.size() == EVENTS_PER_THREAD };
+            size_t first { wrapped ? buffer->next : 0 };
+            for(size_t i = 0; i < buffer->events.size(); i++) {
+                events.push_back(buffer->events[(first + i) % buffer->events.size()]);
+            }
+        }
+    }
+
+    std::ofstream file(tracePath);
+    if(!file) {
+        return false;
+    }
+
+    Uint64 startTicks { events.empty() ? 0 : std::min_element(events.begin(), events.end(),
+        [](const Event & lhs, const Event & rhs) { return lhs.ticks < rhs.ticks; })->ticks };
+    auto frequency { static_cast<double>(SDL_GetPerformanceFrequency()) };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool firstEvent { true };
+    for(const auto & [tid, name] : names) {
+        file << (firstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"" << name << "\"}}";
+        firstEvent = false;
+    }
+
+    file.precision(3);
+    file << std::fixed;
+    for(const auto & event : events) {
+        double timestamp { static_cast<double>(event.ticks - startTicks) * 1000000.0 / frequency };
+        file << (firstEvent ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+            << "\",\"ts\":" << timestamp << ",\"pid\":1,\"tid\":" << event.tid;
+
+        if(event.phase == 'C') {
+            file << ",\"id\":" << event.id << ",\"args\":{\"bytes\":" << event.value << "}";
+        }
+
+        file << "}";
+        firstEvent = false;
+    }
+
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+#endif // TYPECHART_PROFILER
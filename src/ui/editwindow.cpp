@@ -16,7 +16,9 @@
 #include "ui/preferences.hpp"
 #include "ui/editwindow.hpp"
 
+#include "resources/texture.hpp"
 #include "systems/audiosystem.hpp"
+#include "systems/profiler.hpp"
 
 using json = nlohmann::json;
 
@@ -45,7 +47,7 @@ const char * getKeyFrequencyLabels(void * data, int i) {
 } // namespace utils
 
 
-EditWindow::EditWindow(bool open, int ID, int musicSourceIdx, std::string_view name, std::shared_ptr<SDL_Texture> artTexture,
+EditWindow::EditWindow(bool open, int ID, int musicSourceIdx, std::string_view name, std::shared_ptr<TextureCache::Entry> artTexture,
     const ChartInfo & chartinfo, const SongInfo & songinfo)
     : open(open)
     , ID(ID)
@@ -68,33 +70,32 @@ void EditWindow::saveCurrentChartFiles(std::string_view chartSaveFilename, const
     unsaved = false;
     name = chartSaveFilename;
 
-    lastSavedActionIndex = static_cast<int>(timeline.getUndoStackSize());
+    lastSavedActionIndex = timeline.history.getPosition();
 }
 
 void EditWindow::undoLastAction() {
-    if(!timeline.undoStack.empty()) {
-        auto action = timeline.undoStack.top();
-        action->undoAction(this);
+    if(timeline.history.undo(this)) {
+        refreshSelection();
 
-        timeline.redoStack.push(action);
-        timeline.undoStack.pop();
-
-        unsaved = static_cast<int>(timeline.undoStack.size()) != lastSavedActionIndex;
+        unsaved = timeline.history.getPosition() != lastSavedActionIndex;
     }
 }
 
 void EditWindow::redoLastAction() {
-    if(!timeline.redoStack.empty()) {
-        auto action = timeline.redoStack.top();
-        action->redoAction(this);
-
-        timeline.undoStack.push(action);
-        timeline.redoStack.pop();
+    if(timeline.history.redo(this)) {
+        refreshSelection();
         unsaved = true;
     }
 }
 
+void EditWindow::refreshSelection() {
+    // the action may have deleted or moved selected items
+    timeline.selection.removeDeleted();
+    timeline.selection.sort();
+}
+
 void EditWindow::showContents(AudioSystem * audioSystem, std::vector<bool> & keysPressed) {
+    updateLoop(audioSystem);
     showMetadata();
 
     ImGui::SameLine();
@@ -104,7 +105,123 @@ void EditWindow::showContents(AudioSystem * audioSystem, std::vector<bool> & key
     showToolbar(audioSystem, keysPressed);
 
     ImGui::Separator();
+    updateHitsounds(audioSystem);
+    updateMetronome(audioSystem);
+    chartinfo.notes.setWaveform(Preferences::Instance().isWaveformShown() ? waveform.get() : nullptr, &songpos.timeinfo, songpos.offsetMS);
     timeline.showContents(musicSourceIdx, focused, unsaved, audioSystem, chartinfo, songpos, keysPressed);
+
+    showMixdownExportWindow();
+}
+
+void EditWindow::exportMixdown(AudioSystem * audioSystem, const fs::path & outputPath) {
+    if(!mixdownExporter) {
+        mixdownExporter = std::make_shared<MixdownExporter>();
+    }
+
+    // the notesound is taken already converted to the music's format
+    auto soundSamples { audioSystem->getHitsoundSamples(musicSourceIdx, audioSystem->getSoundHandle("keypress")) };
+    mixdownExporter->start(songinfo.musicFilepath, outputPath, std::move(soundSamples),
+        chartinfo.notes.getNoteTimes(songpos.timeinfo, songpos.offsetMS));
+
+    showMixdownExport = true;
+}
+
+void EditWindow::showMixdownExportWindow() {
+    if(!showMixdownExport || !mixdownExporter) {
+        return;
+    }
+
+    std::string windowTitle { "Export Mixdown##" + std::to_string(ID) };
+    ImGui::Begin(windowTitle.c_str(), &showMixdownExport, ImGuiWindowFlags_AlwaysAutoResize);
+
+    if(mixdownExporter->hasFailed()) {
+        ImGui::Text("Unable to export the mixdown");
+    } else if(!mixdownExporter->isFinished()) {
+        ImGui::Text("Exporting mixdown...");
+        ImGui::ProgressBar(mixdownExporter->getProgress(), ImVec2(256.f, 0.f));
+
+        if(ImGui::Button("Cancel")) {
+            mixdownExporter->stop();
+            showMixdownExport = false;
+        }
+    } else {
+        ImGui::Text("Mixdown exported");
+    }
+
+    ImGui::End();
+
+    if(!showMixdownExport && mixdownExporter->isRunning()) {
+        mixdownExporter->stop();
+    }
+}
+
+void EditWindow::updateHitsounds(AudioSystem * audioSystem) {
+    if(!Preferences::Instance().isNotesoundEnabled() || !Preferences::Instance().isNotesoundMixed()) {
+        if(hitsoundsScheduled) {
+            audioSystem->clearHitsounds(musicSourceIdx);
+            hitsoundsScheduled = false;
+        }
+
+        return;
+    }
+
+    if(hitsoundsScheduled && hitsoundsNotesRevision == chartinfo.notes.revision &&
+        hitsoundsTimingRevision == songpos.timingRevision && hitsoundsOffsetMS == songpos.offsetMS)
+    {
+        return;
+    }
+
+    // already queued music buffers keep their old mix, so edits are heard from the next buffer on
+    audioSystem->setHitsounds(musicSourceIdx, audioSystem->getSoundHandle("keypress"), chartinfo.notes.getNoteTimes(songpos.timeinfo, songpos.offsetMS));
+
+    hitsoundsScheduled = true;
+    hitsoundsNotesRevision = chartinfo.notes.revision;
+    hitsoundsTimingRevision = songpos.timingRevision;
+    hitsoundsOffsetMS = songpos.offsetMS;
+}
+
+void EditWindow::updateMetronome(AudioSystem * audioSystem) {
+    if(!Preferences::Instance().isMetronomeEnabled()) {
+        if(metronomeScheduled) {
+            audioSystem->clearMetronome(musicSourceIdx);
+            metronomeScheduled = false;
+        }
+
+        return;
+    }
+
+    if(metronomeScheduled && metronomeTimingRevision == songpos.timingRevision && metronomeOffsetMS == songpos.offsetMS) {
+        return;
+    }
+
+    std::vector<AudioSystem::MetronomeSection> sections;
+    for(const auto & section : songpos.timeinfo) {
+        const auto & beatpos = section.beatpos;
+        double startMeasure { beatpos.measure + static_cast<double>(beatpos.split) / beatpos.measureSplit };
+        sections.push_back({ section.absTimeStart + (songpos.offsetMS / 1000.0), startMeasure, section.bpm, section.beatsPerMeasure });
+    }
+
+    audioSystem->setMetronome(musicSourceIdx, std::move(sections));
+
+    metronomeScheduled = true;
+    metronomeTimingRevision = songpos.timingRevision;
+    metronomeOffsetMS = songpos.offsetMS;
+}
+
+size_t EditWindow::MemoryUsage::getTotal() const {
+    return notes + undoHistory + clipboard + audio + waveform + textures;
+}
+
+EditWindow::MemoryUsage EditWindow::getMemoryUsage(const AudioSystem * audioSystem) const {
+    MemoryUsage usage;
+    usage.notes = chartinfo.notes.getMemoryUsage();
+    usage.undoHistory = timeline.getHistoryMemoryUsage();
+    usage.clipboard = timeline.getClipboardMemoryUsage();
+    usage.audio = audioSystem->getMemoryUsage(musicSourceIdx);
+    usage.waveform = waveform ? waveform->getMemoryUsage() : 0;
+    usage.textures = artTexture ? Texture::getMemoryUsage(artTexture->texture.get()) : 0;
+
+    return usage;
 }
 
 void EditWindow::showMetadata() {
@@ -191,9 +308,17 @@ bool EditWindow::showChartConfig() {
 }
 
 void EditWindow::showChartData(AudioSystem * audioSystem) {
+    PROFILE_SCOPE(CHART_DATA);
+
     ImGui::BeginChild("chartData", ImVec2(0, ImGui::GetContentRegionAvail().y * .35f), true);
 
-    ImGui::Image(artTexture.get(), ImVec2(ImGui::GetContentRegionAvail().y, ImGui::GetContentRegionAvail().y));
+    // keep the space while the art is still decoding
+    ImVec2 artSize { ImGui::GetContentRegionAvail().y, ImGui::GetContentRegionAvail().y };
+    if(artTexture && artTexture->texture) {
+        ImGui::Image(artTexture->texture.get(), artSize);
+    } else {
+        ImGui::Dummy(artSize);
+    }
 
     ImGui::SameLine();
     showChartSections(audioSystem);
@@ -232,7 +357,11 @@ void EditWindow::showChartSections(AudioSystem * audioSystem) {
         initSectionData = true;
     }
 
+    ImGui::SameLine();
+    showDetectTempo();
+
     showSectionDataWindow(newSection, newSectionEdit, initSectionData);
+    showTempoDetectionWindow();
     showChartSectionList(audioSystem);
 
     ImGui::EndChild();
@@ -273,29 +402,124 @@ void EditWindow::showRemoveSection() {
     }
 }
 
+void EditWindow::showDetectTempo() {
+    if(ImGui::Button("Detect")) {
+        if(!tempoAnalyzer) {
+            tempoAnalyzer = std::make_shared<TempoAnalyzer>();
+        }
+
+        if(!tempoAnalyzer->isRunning() && !tempoAnalyzer->isFinished()) {
+            tempoAnalyzer->start(songinfo.musicFilepath);
+        }
+
+        showTempoDetection = true;
+    }
+
+    if(ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Detect the BPM, offset and tempo changes from the music");
+    }
+}
+
+void EditWindow::showTempoDetectionWindow() {
+    if(!showTempoDetection || !tempoAnalyzer) {
+        return;
+    }
+
+    std::string windowTitle { "Tempo Detection##" + std::to_string(ID) };
+    ImGui::Begin(windowTitle.c_str(), &showTempoDetection, ImGuiWindowFlags_AlwaysAutoResize);
+
+    if(tempoAnalyzer->hasFailed()) {
+        ImGui::Text("Unable to detect a tempo for this song");
+    } else if(!tempoAnalyzer->isFinished()) {
+        ImGui::Text("Analyzing music...");
+        ImGui::ProgressBar(tempoAnalyzer->getProgress(), ImVec2(256.f, 0.f));
+    } else {
+        const auto & estimate { tempoAnalyzer->getEstimate() };
+
+        ImGui::Text("BPM: %g", estimate.bpm);
+        ImGui::Text("Offset: %d ms", estimate.offsetMS);
+        ImGui::Text("Confidence: %.0f%%", estimate.confidence * 100.0);
+        ImGui::SameLine();
+        utils::HelpMarker("Detected tempos may be half or double the intended BPM.\n"
+                          "Use the x2 / /2 buttons when editing the section to adjust.");
+
+        if(ImGui::Button("Apply BPM and Offset")) {
+            applyDetectedTempo(estimate);
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Tempo changes: %d", static_cast<int>(estimate.tempoChanges.size()));
+        for(const auto & change : estimate.tempoChanges) {
+            auto [minutes, seconds] { utils::splitSecsbyMin(change.time) };
+            ImGui::BulletText("%d:%05.2f -> BPM: %g", minutes, seconds, change.bpm);
+        }
+
+        ImGui::BeginDisabled(estimate.tempoChanges.empty());
+        if(ImGui::Button("Apply Tempo Changes")) {
+            applyDetectedTempoChanges(estimate);
+        }
+        ImGui::EndDisabled();
+
+        ImGui::SameLine();
+        utils::HelpMarker("Adds a section at the nearest beat of each tempo change.\n"
+                          "Apply the BPM and offset first so the changes line up.");
+    }
+
+    ImGui::End();
+}
+
+void EditWindow::applyDetectedTempo(const TempoAnalyzer::TempoEstimate & estimate) {
+    songpos.setSectionBPM(0, estimate.bpm);
+    songpos.offsetMS = std::clamp(estimate.offsetMS, -1000, 1000);
+    chartinfo.offsetMS = songpos.offsetMS;
+
+    unsaved = true;
+}
+
+void EditWindow::applyDetectedTempoChanges(const TempoAnalyzer::TempoEstimate & estimate) {
+    for(const auto & change : estimate.tempoChanges) {
+        // music time -> chart beat, snapped to the nearest whole beat of the current sections
+        double changeTime { change.time - (songpos.offsetMS / 1000.0) };
+        double absBeat { std::round(utils::calculateAbsBeat(changeTime, songpos.timeinfo)) };
+
+        int beatsPerMeasure { constants::DEFAULT_BEATS_PER_MEASURE };
+        for(const auto & section : songpos.timeinfo) {
+            if(section.absBeatStart <= absBeat) {
+                beatsPerMeasure = section.beatsPerMeasure;
+            }
+        }
+
+        BeatPos beatpos { utils::calculateBeatpos(absBeat, 1, songpos.timeinfo) };
+        songpos.addSection(beatsPerMeasure, change.bpm, 0.0, beatpos);
+    }
+
+    unsaved = true;
+}
+
 void EditWindow::showChartSectionList(AudioSystem * audioSystem) {
-    // display section info
+    updateSectionLabels();
+
+    // display section info, submitting only the visible rows
     if(ImGui::BeginListBox("##chartsections", ImVec2(ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y))) {
-        for(unsigned int i = 0; i < songpos.timeinfo.size(); i++) {
-            Timeinfo currSection = songpos.timeinfo.at(i);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(sectionLabels.size()));
 
-            char sectionDesc[256];
-            snprintf(sectionDesc, 256, "[%d,%d,%d] : BPM: %.1f, Beats / measure: %d", currSection.beatpos.measure, currSection.beatpos.measureSplit,
-                currSection.beatpos.split, currSection.bpm, currSection.beatsPerMeasure);
+        while(clipper.Step()) {
+            for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                bool isSelected = static_cast<unsigned int>(i) == songpos.currentSection;
 
-            bool isSelected = i == songpos.currentSection;
+                if(ImGui::Selectable(sectionLabels[i].c_str(), &isSelected, ImGuiSelectableFlags_SelectOnClick)) {
+                    if(!songpos.started) {
+                        songpos.start();
+                        songpos.pause();
 
-            if(ImGui::Selectable(sectionDesc, &isSelected, ImGuiSelectableFlags_SelectOnClick)) {
-                if(!songpos.started) {
-                    songpos.start();
-                    songpos.pause();
+                        songpos.pauseCounter += static_cast<Uint64>((songpos.offsetMS / 1000.0) * SDL_GetPerformanceFrequency());
+                    }
 
-                    songpos.pauseCounter += static_cast<Uint64>((songpos.offsetMS / 1000.0) * SDL_GetPerformanceFrequency());
+                    songpos.setSongBeatPosition(songpos.timeinfo.at(i).absBeatStart + FLT_EPSILON);
+                    chartinfo.notes.resetPassed(songpos.absBeat);
+                    utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
                 }
-
-                songpos.setSongBeatPosition(currSection.absBeatStart + FLT_EPSILON);
-                chartinfo.notes.resetPassed(songpos.absBeat);
-                utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
             }
         }
 
@@ -303,6 +527,24 @@ void EditWindow::showChartSectionList(AudioSystem * audioSystem) {
     }
 }
 
+void EditWindow::updateSectionLabels() {
+    // every section change bumps the timing revision; a new window's sections may not have yet
+    if(sectionLabelsTimingRevision == songpos.timingRevision && sectionLabels.size() == songpos.timeinfo.size()) {
+        return;
+    }
+
+    sectionLabels.clear();
+    for(const auto & section : songpos.timeinfo) {
+        char sectionDesc[256];
+        snprintf(sectionDesc, 256, "[%d,%d,%d] : BPM: %.1f, Beats / measure: %d", section.beatpos.measure, section.beatpos.measureSplit,
+            section.beatpos.split, section.bpm, section.beatsPerMeasure);
+
+        sectionLabels.emplace_back(sectionDesc);
+    }
+
+    sectionLabelsTimingRevision = songpos.timingRevision;
+}
+
 void EditWindow::showSectionDataWindow(bool & newSection, bool newSectionEdit, bool initSectionData) {
     auto currSection = songpos.timeinfo.at(songpos.currentSection);
 
@@ -467,6 +709,136 @@ void EditWindow::showMusicControls(AudioSystem * audioSystem, std::vector<bool>
         songpos.stop();
         chartinfo.notes.resetPassed(songpos.absBeat);
     }
+
+    ImGui::SameLine();
+    showPlaybackRate(audioSystem);
+
+    ImGui::SameLine();
+    showLoopToggle(audioSystem);
+}
+
+void EditWindow::showPlaybackRate(AudioSystem * audioSystem) {
+    char rateText[16];
+    snprintf(rateText, 16, "%.2fx", songpos.playbackRate);
+
+    ImGui::SetNextItemWidth(80);
+    if(ImGui::BeginCombo("##playbackRate", rateText)) {
+        for(auto rate : constants::PLAYBACK_RATES) {
+            snprintf(rateText, 16, "%.2fx", rate);
+            if(ImGui::Selectable(rateText, rate == songpos.playbackRate) && rate != songpos.playbackRate) {
+                setPlaybackRate(audioSystem, rate);
+            }
+        }
+
+        ImGui::EndCombo();
+    }
+
+    if(ImGui::IsItemHovered() && !ImGui::IsItemActive())
+        ImGui::SetTooltip("Playback speed (pitch is kept)");
+}
+
+void EditWindow::setPlaybackRate(AudioSystem * audioSystem, double rate) {
+    songpos.setPlaybackRate(rate);
+    audioSystem->setPlaybackRate(musicSourceIdx, rate);
+
+    // requeue the music, since the buffers already queued were stretched for the old rate
+    if(songpos.started && songpos.absTime >= 0) {
+        utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+    }
+}
+
+void EditWindow::showLoopToggle(AudioSystem * audioSystem) {
+    bool canLoop { timeline.haveSelection && timeline.endBeat > timeline.insertBeat };
+
+    ImGui::BeginDisabled(!loopEnabled && !canLoop);
+    if(loopEnabled) {
+        ImGui::PushStyleColor(ImGuiCol_Button, ImGui::GetStyleColorVec4(ImGuiCol_ButtonActive));
+    }
+
+    if(ImGui::Button(ICON_FA_REPEAT)) {
+        setLoopEnabled(audioSystem, !loopEnabled);
+    }
+
+    if(loopEnabled) {
+        ImGui::PopStyleColor();
+    }
+    ImGui::EndDisabled();
+
+    if(ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled) && !ImGui::IsItemActive())
+        ImGui::SetTooltip("Loop the selected region (Shift + drag in the timeline to select)");
+}
+
+void EditWindow::setLoopEnabled(AudioSystem * audioSystem, bool enabled) {
+    loopEnabled = enabled;
+
+    if(!enabled) {
+        audioSystem->clearMusicLoop(musicSourceIdx);
+        return;
+    }
+
+    loopStartBeat = timeline.insertBeat;
+    loopEndBeat = timeline.endBeat;
+    loopStartTime = 0.f;
+    loopEndTime = 0.f;
+    updateLoop(audioSystem, false);
+
+    // start from the top of the loop; this seek requeues the music once for the new loop
+    if(!songpos.started) {
+        songpos.start();
+        songpos.pause();
+
+        songpos.pauseCounter += static_cast<Uint64>((songpos.offsetMS / 1000.0) * static_cast<double>(SDL_GetPerformanceFrequency()));
+    }
+
+    songpos.setSongBeatPosition(loopStartBeat);
+    if(songpos.absTime >= 0) {
+        utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+    }
+
+    chartinfo.notes.resetPassed(songpos.absBeat);
+}
+
+void EditWindow::updateLoop(AudioSystem * audioSystem, bool requeue) {
+    if(!loopEnabled || songpos.timeinfo.empty()) {
+        return;
+    }
+
+    // the loop follows the selection while it's there
+    if(timeline.haveSelection && timeline.endBeat > timeline.insertBeat) {
+        loopStartBeat = timeline.insertBeat;
+        loopEndBeat = timeline.endBeat;
+    }
+
+    double startTime { utils::calculateAbsTime(loopStartBeat, songpos.timeinfo) };
+    double endTime { utils::calculateAbsTime(loopEndBeat, songpos.timeinfo) };
+
+    // section and offset edits move the loop in the music, too
+    auto musicStart { static_cast<float>(startTime + songpos.offsetMS / 1000.0) };
+    auto musicEnd { static_cast<float>(endTime + songpos.offsetMS / 1000.0) };
+    // setting the loop decodes all of it, so wait until a drag of the selection or a timing slider is let go
+    bool editing { ImGui::IsMouseDown(ImGuiMouseButton_Left) || ImGui::IsAnyItemActive() };
+    bool loopChanged { false };
+    if((musicStart != loopStartTime || musicEnd != loopEndTime) && !editing) {
+        if(!audioSystem->setMusicLoop(musicSourceIdx, musicStart, musicEnd)) {
+            loopEnabled = false;
+            return;
+        }
+
+        loopStartTime = musicStart;
+        loopEndTime = musicEnd;
+        loopChanged = true;
+    }
+
+    // the audio wraps on its own at the loop it was last given; the song position and notes follow it
+    double offsetSecs { songpos.offsetMS / 1000.0 };
+    if(songpos.wrapLoop(loopStartTime - offsetSecs, loopEndTime - offsetSecs)) {
+        chartinfo.notes.resetPassed(songpos.absBeat);
+    }
+
+    // buffers already queued were cut at the old loop; requeue from here, which also resets the wrap counts
+    if(requeue && loopChanged && songpos.started && songpos.absTime >= 0) {
+        utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+    }
 }
 
 void EditWindow::showMusicPreview(AudioSystem * audioSystem, float musicLengthSecs) {
@@ -2,6 +2,7 @@
 
 #include "config/constants.hpp"
 #include "config/utils.hpp"
+#include "systems/tracer.hpp"
 #include "ui/preferences.hpp"
 #include "ui/windowsizes.hpp"
 
@@ -48,14 +49,16 @@ std::string EditWindowManager::loadEditWindow(SDL_Renderer * renderer, AudioSyst
     ChartInfo chartinfo;
     SongPosition songpos;
     if(!chartinfo.loadChart(chartPath, songpos)) {
+        audioSystem->deactivateMusicSource(musicSourceIdx);
         return "Failed to open chart";
     }
 
     auto [_, windowID] { getNextWindowNameAndID() };
     std::string windowName { chartinfo.savePath.filename().string() +  " (" + songinfo.getSongID() + ")" };
-    auto artTexture { Texture::loadTexture(songinfo.coverartFilepath, renderer) };
+    auto artTexture { artCache.load(songinfo.coverartFilepath) };
 
     EditWindow newWindow { true, windowID, musicSourceIdx, windowName, artTexture, chartinfo, songinfo };
+    newWindow.waveform = getWaveform(audioSystem, musicSourceIdx, songinfo.musicFilepath);
 
     newWindow.unsaved = false;
     newWindow.songpos = songpos;
@@ -191,6 +194,15 @@ void EditWindowManager::startSaveCurrentChart(bool saveAs) {
     }
 }
 
+void EditWindowManager::startExportMixdown() const {
+    if(currentWindow < editWindows.size()) {
+        const auto & editWindow = editWindows.at(currentWindow);
+        auto defaultName { fs::path(editWindow.name).stem().string() + ".wav" };
+        ImGuiFileDialog::Instance()->OpenModal("exportMixdown", "Export mixdown", constants::mixdownFileFilter.c_str(), lastChartSaveDir,
+            defaultName, 1, nullptr, ImGuiFileDialogFlags_ConfirmOverwrite);
+    }
+}
+
 void EditWindowManager::showInitEditWindow(AudioSystem * audioSystem, SDL_Renderer * renderer) {
     if(newEditStarted) {
         ImGui::SetNextWindowSize(constants::newEditWindowSize);
@@ -231,6 +243,20 @@ std::pair<std::string, int> EditWindowManager::getNextWindowNameAndID() {
     return std::make_pair(windowName, windowID);
 }
 
+std::shared_ptr<Waveform> EditWindowManager::getWaveform(AudioSystem * audioSystem, int musicSourceIdx, const fs::path & musicPath) const {
+    // other difficulties of the same song already have one
+    for(const auto & editWindow : editWindows) {
+        if(editWindow.waveform && audioSystem->isSameMusic(editWindow.musicSourceIdx, musicSourceIdx)) {
+            return editWindow.waveform;
+        }
+    }
+
+    auto waveform { std::make_shared<Waveform>(musicPath) };
+    waveform->build();
+
+    return waveform;
+}
+
 void EditWindowManager::createNewEditWindow(AudioSystem * audioSystem, SDL_Renderer * renderer) {
     // populate with current song, chart info
     SongInfo songinfo { UItitle, UIartist, UIgenre, UIbpmtext, UImusicFilename, UIcoverArtFilename,
@@ -247,15 +273,22 @@ void EditWindowManager::createNewEditWindow(AudioSystem * audioSystem, SDL_Rende
         popupFailedToLoadMusic = false;
 
         auto [windowName, windowID] { getNextWindowNameAndID() };
-        auto artTexture { Texture::loadTexture(UIcoverArtFilepath, renderer) };
+        auto artTexture { artCache.load(UIcoverArtFilepath) };
 
         EditWindow newWindow { true, windowID, musicSourceIdx, windowName, artTexture, chartinfo, songinfo };
         newWindow.resetInfoDisplay = true;
+        newWindow.waveform = getWaveform(audioSystem, musicSourceIdx, UImusicFilepath);
 
         // initial section from BPM
         double initialBpm = ::atof(UIbpmtext);
         BeatPos initialSectionStart { 0, 1, 0 };
         newWindow.songpos.timeinfo.emplace_back(initialSectionStart, nullptr, 4, initialBpm, 0);
+
+        // keep the offset found alongside a detected bpm
+        if(bpmDetectionApplied && bpmDetectionMusicFilepath == UImusicFilepath) {
+            newWindow.songpos.offsetMS = std::clamp(bpmDetectionOffsetMS, -1000, 1000);
+            newWindow.chartinfo.offsetMS = newWindow.songpos.offsetMS;
+        }
     
         editWindows.push_back(newWindow);
         newEditStarted = false;
@@ -343,6 +376,7 @@ void EditWindowManager::showEditWindows(AudioSystem * audioSystem, std::vector<b
     }
 
     showSaveChart(updatedName, sizeBeforeUpdate, currWindowSize);
+    showExportMixdown(audioSystem);
     checkUndoRedo();
 }
 
@@ -385,6 +419,22 @@ void EditWindowManager::showSaveChart(bool & updatedName, ImVec2 & sizeBeforeUpd
     }
 }
 
+void EditWindowManager::showExportMixdown(AudioSystem * audioSystem) {
+    if(ImGuiFileDialog::Instance()->Display("exportMixdown", ImGuiWindowFlags_NoCollapse, constants::minFDSize, constants::maxFDSize)) {
+        if(ImGuiFileDialog::Instance()->IsOk() && currentWindow < editWindows.size()) {
+            std::string mixdownPath = ImGuiFileDialog::Instance()->GetFilePathName();
+            editWindows.at(currentWindow).exportMixdown(audioSystem, fs::path(mixdownPath));
+
+            ImGuiIO& io = ImGui::GetIO();
+            io.MouseClicked[0] = false;
+            io.MouseClicked[1] = false;
+            io.MouseClicked[2] = false;
+        }
+
+        ImGuiFileDialog::Instance()->Close();
+    }
+}
+
 void EditWindowManager::checkUndoRedo() {
     if(activateUndo) {
         if(currentWindow < editWindows.size()) {
@@ -482,11 +532,36 @@ void EditWindowManager::showSongConfig() {
     ImGui::InputText(ICON_FA_HEADING " Title", UItitle, 64);
     ImGui::InputText(ICON_FA_MICROPHONE " Artist", UIartist, 64);
     ImGui::InputText(ICON_FA_COMPACT_DISC " Genre", UIgenre, 64);
-    ImGui::InputText(ICON_FA_HEART_PULSE " BPM", UIbpmtext, 64);
+    ImGui::InputText(ICON_FA_HEART_PULSE " BPM", UIbpmtext, 16);
+    ImGui::SameLine();
+    showDetectBPM();
     ImGui::SameLine();
     utils::HelpMarker("If the song has BPM changes, enter the initial BPM.\nYou will be able to add BPM changes later.");
 }
 
+void EditWindowManager::showDetectBPM() {
+    ImGui::BeginDisabled(UImusicFilepath.empty() || bpmAnalyzer.isRunning());
+    if(ImGui::Button(ICON_FA_WAND_MAGIC_SPARKLES "##detectbpm")) {
+        bpmAnalyzer.start(UImusicFilepath);
+        bpmDetectionMusicFilepath = UImusicFilepath;
+        bpmDetectionApplied = false;
+    }
+    ImGui::EndDisabled();
+
+    if(ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("Detect the BPM and offset from the selected music");
+    }
+
+    if(bpmAnalyzer.isRunning()) {
+        ImGui::SameLine();
+        ImGui::ProgressBar(bpmAnalyzer.getProgress(), ImVec2(64.f, 0.f));
+    } else if(bpmAnalyzer.isFinished() && !bpmDetectionApplied) {
+        snprintf(UIbpmtext, 16, "%g", bpmAnalyzer.getEstimate().bpm);
+        bpmDetectionOffsetMS = bpmAnalyzer.getEstimate().offsetMS;
+        bpmDetectionApplied = true;
+    }
+}
+
 void EditWindowManager::showChartConfig() {
     ImGui::Text("Chart configuration");
 
@@ -501,6 +576,106 @@ void EditWindowManager::showChartConfig() {
     ImGui::InputInt(ICON_FA_CHESS_ROOK " Level", &UIlevel);
 }
 
+void EditWindowManager::uploadCoverArt(SDL_Renderer * renderer) {
+    artCache.upload(renderer);
+}
+
+bool EditWindowManager::isBusy() const {
+    if(bpmAnalyzer.isRunning() || artCache.isLoading() || ImGuiFileDialog::Instance()->IsOpened()) {
+        return true;
+    }
+
+    return std::any_of(editWindows.begin(), editWindows.end(), [](const EditWindow & editWindow) {
+        return (editWindow.tempoAnalyzer && editWindow.tempoAnalyzer->isRunning()) ||
+            (editWindow.mixdownExporter && editWindow.mixdownExporter->isRunning()) ||
+            (editWindow.waveform && !editWindow.waveform->isFinished());
+    });
+}
+
+bool EditWindowManager::isPlaying() const {
+    return std::any_of(editWindows.begin(), editWindows.end(), [](const EditWindow & editWindow) {
+        return editWindow.songpos.started && !editWindow.songpos.paused;
+    });
+}
+
+void EditWindowManager::setShowMemoryUsage(bool showMemoryUsage) {
+    memoryUsageShown = showMemoryUsage;
+}
+
+void EditWindowManager::showMemoryUsage(const AudioSystem * audioSystem) {
+    bool tracing { false };
+#ifdef TYPECHART_PROFILER
+    tracing = Tracer::Instance().isRecording();
+#endif
+
+    if(!memoryUsageShown && !tracing) {
+        return;
+    }
+
+    // walking the note store and the assets isn't free, so don't do it every frame
+    Uint32 now { SDL_GetTicks() };
+    if(memoryUsageTicks == 0 || SDL_TICKS_PASSED(now, memoryUsageTicks + 1000)) {
+        memoryUsageTicks = now;
+        memoryUsages.clear();
+
+        for(const auto & editWindow : editWindows) {
+            auto usage { editWindow.getMemoryUsage(audioSystem) };
+            memoryUsages.emplace_back(editWindow.name, usage);
+
+            TRACE_COUNTER("Notes memory", editWindow.ID, static_cast<double>(usage.notes));
+            TRACE_COUNTER("Undo history memory", editWindow.ID, static_cast<double>(usage.undoHistory));
+            TRACE_COUNTER("Clipboard memory", editWindow.ID, static_cast<double>(usage.clipboard));
+            TRACE_COUNTER("Audio memory", editWindow.ID, static_cast<double>(usage.audio));
+            TRACE_COUNTER("Waveform memory", editWindow.ID, static_cast<double>(usage.waveform));
+            TRACE_COUNTER("Texture memory", editWindow.ID, static_cast<double>(usage.textures));
+        }
+    }
+
+    if(!memoryUsageShown) {
+        return;
+    }
+
+    if(!ImGui::Begin("Memory Usage", &memoryUsageShown, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    auto showKB = [](size_t bytes) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", static_cast<double>(bytes) / 1024.0);
+    };
+
+    if(ImGui::BeginTable("memoryUsage", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Chart");
+        ImGui::TableSetupColumn("Notes (KB)");
+        ImGui::TableSetupColumn("Undo/Redo (KB)");
+        ImGui::TableSetupColumn("Clipboard (KB)");
+        ImGui::TableSetupColumn("Audio (KB)");
+        ImGui::TableSetupColumn("Waveform (KB)");
+        ImGui::TableSetupColumn("Cover Art (KB)");
+        ImGui::TableSetupColumn("Total (KB)");
+        ImGui::TableHeadersRow();
+
+        for(const auto & [name, usage] : memoryUsages) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name.c_str());
+
+            showKB(usage.notes);
+            showKB(usage.undoHistory);
+            showKB(usage.clipboard);
+            showKB(usage.audio);
+            showKB(usage.waveform);
+            showKB(usage.textures);
+            showKB(usage.getTotal());
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
 void EditWindowManager::setCopy(bool copy) {
     editWindows.at(currentWindow).timeline.activateCopy = copy;
 }
@@ -517,6 +692,14 @@ void EditWindowManager::setFlip(bool flip) {
     editWindows.at(currentWindow).timeline.activateFlip = flip;
 }
 
+void EditWindowManager::setSelectAll(bool selectAll) {
+    editWindows.at(currentWindow).timeline.activateSelectAll = selectAll;
+}
+
+void EditWindowManager::setQuantize(bool quantize) {
+    editWindows.at(currentWindow).timeline.activateQuantize = quantize;
+}
+
 void EditWindowManager::setUndo(bool undo) {
     activateUndo = undo;
 }
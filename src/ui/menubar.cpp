@@ -11,6 +11,9 @@ namespace fs = std::filesystem;
 #include "ui/menubar.hpp"
 #include "ui/preferences.hpp"
 
+#include "config/constants.hpp"
+#include "systems/profiler.hpp"
+
 namespace menubar {
 
 void showMenuBar(ImFont * menuFont, SDL_Renderer * renderer, AudioSystem * audioSystem, EditWindowManager & editWindowManager) {
@@ -32,7 +35,7 @@ void showMenuBar(ImFont * menuFont, SDL_Renderer * renderer, AudioSystem * audio
         }
 
         if(ImGui::BeginMenu("Options")) {
-            showOptionMenu();
+            showOptionMenu(editWindowManager);
             ImGui::EndMenu();
         }
 
@@ -82,6 +85,12 @@ std::string showFileMenu(SDL_Renderer * renderer, AudioSystem * audioSystem, Edi
         editWindowManager.startSaveCurrentChart(true);
     }
 
+    ImGui::Separator();
+
+    if(ImGui::MenuItem("Export Mixdown...")) {
+        editWindowManager.startExportMixdown();
+    }
+
     return popupID;
 }
 
@@ -108,14 +117,22 @@ void showEditMenu(EditWindowManager & editWindowManager) {
         editWindowManager.setPaste(true);
     }
 
+    if(ImGui::MenuItem("Select All", "Ctrl+A")) {
+        editWindowManager.setSelectAll(true);
+    }
+
     ImGui::Separator();
 
     if(ImGui::MenuItem("Flip", "F")) {
         editWindowManager.setFlip(true);
     }
+
+    if(ImGui::MenuItem("Quantize", "Q")) {
+        editWindowManager.setQuantize(true);
+    }
 }
 
-void showOptionMenu() {
+void showOptionMenu(EditWindowManager & editWindowManager) {
     if(ImGui::MenuItem("Preferences", "Ctrl+P")) {
         Preferences::Instance().setShowPreferences(true);
     }
@@ -133,6 +150,30 @@ void showOptionMenu() {
 
         ImGui::EndMenu();
     }
+
+    if(ImGui::MenuItem("Memory Usage")) {
+        editWindowManager.setShowMemoryUsage(true);
+    }
+
+#ifdef TYPECHART_PROFILER
+    if(ImGui::MenuItem("Profiler", nullptr, Profiler::Instance().isOverlayShown())) {
+        Profiler::Instance().setShowOverlay(!Profiler::Instance().isOverlayShown());
+    }
+
+    // stopping a recording, or quitting during one, saves the trace as well
+    bool tracing { Tracer::Instance().isRecording() };
+    if(ImGui::MenuItem("Record Trace", nullptr, tracing)) {
+        if(tracing) {
+            Tracer::Instance().save(constants::TRACE_PATH);
+        }
+
+        Tracer::Instance().setRecording(!tracing);
+    }
+
+    if(ImGui::MenuItem("Save Trace", nullptr, false, tracing)) {
+        Tracer::Instance().save(constants::TRACE_PATH);
+    }
+#endif
 }
 
 } // namespace menubar
@@ -7,6 +7,7 @@ using ordered_json = nlohmann::ordered_json;
 #include "imgui.h"
 #include "ImGuiFileDialog.h"
 
+#include "config/utils.hpp"
 #include "systems/audiosystem.hpp"
 #include "ui/preferences.hpp"
 #include "ui/windowsizes.hpp"
@@ -68,7 +69,24 @@ void Preferences::showPreferencesWindow(AudioSystem * audioSystem) {
         }
 
         ImGui::Checkbox("Enable Notesounds", &enableNotesound);
+        ImGui::Checkbox("Sample-accurate Notesounds", &mixNotesound);
+        ImGui::SameLine();
+        utils::HelpMarker("Mix notesounds into the music at the exact time of each note,\n"
+            "instead of playing them when the screen passes the note.");
+        ImGui::Checkbox("Audible Scrubbing", &scrubAudio);
+        ImGui::SameLine();
+        utils::HelpMarker("Play short snippets of the music while moving the playhead\n"
+            "with the music paused.");
+        ImGui::Checkbox("Metronome", &metronome);
+        ImGui::SameLine();
+        utils::HelpMarker("Mix a click into the music on every beat of the chart's sections,\n"
+            "accented on the first beat of each measure.");
+        ImGui::Checkbox("Show Waveform", &showWaveform);
         ImGui::Checkbox("Copy Art and Music when Saving", &copyArtAndMusic);
+        ImGui::SliderInt("Undo history limit (MB)", &undoHistoryMB, 1, 1024, "%d", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::SameLine();
+        utils::HelpMarker("Memory each chart's undo history may use.\n"
+            "The oldest edits can no longer be undone once it is full.");
 
         ImGui::End();
     }
@@ -93,10 +111,30 @@ void Preferences::loadFromFile(std::string preferencesPath) {
             enableNotesound = preferencesJSON["enableNotesound"];
         }
 
+        if(preferencesJSON.contains("mixNotesound")) {
+            mixNotesound = preferencesJSON["mixNotesound"];
+        }
+
+        if(preferencesJSON.contains("scrubAudio")) {
+            scrubAudio = preferencesJSON["scrubAudio"];
+        }
+
+        if(preferencesJSON.contains("metronome")) {
+            metronome = preferencesJSON["metronome"];
+        }
+
+        if(preferencesJSON.contains("showWaveform")) {
+            showWaveform = preferencesJSON["showWaveform"];
+        }
+
         if(preferencesJSON.contains("copyAssetsWhenSaving")) {
             copyArtAndMusic = preferencesJSON["copyAssetsWhenSaving"];
         }
 
+        if(preferencesJSON.contains("undoHistoryMB")) {
+            undoHistoryMB = std::clamp(preferencesJSON["undoHistoryMB"].get<int>(), 1, 1024);
+        }
+
         if(preferencesJSON.contains("theme")) {
             darkTheme = preferencesJSON["theme"] == "dark";
         }
@@ -130,7 +168,12 @@ void Preferences::saveToFile(std::string preferencesPath) {
     preferencesJSON["musicVolume"] = musicVolume;
     preferencesJSON["soundVolume"] = soundVolume;
     preferencesJSON["enableNotesound"] = enableNotesound;
+    preferencesJSON["mixNotesound"] = mixNotesound;
+    preferencesJSON["scrubAudio"] = scrubAudio;
+    preferencesJSON["metronome"] = metronome;
+    preferencesJSON["showWaveform"] = showWaveform;
     preferencesJSON["copyAssetsWhenSaving"] = copyArtAndMusic;
+    preferencesJSON["undoHistoryMB"] = undoHistoryMB;
 
     preferencesJSON["theme"] = darkTheme ? "dark" : "light";
 
@@ -152,6 +195,22 @@ bool Preferences::isNotesoundEnabled() const {
     return enableNotesound;
 }
 
+bool Preferences::isNotesoundMixed() const {
+    return mixNotesound;
+}
+
+bool Preferences::isAudioScrubbed() const {
+    return scrubAudio;
+}
+
+bool Preferences::isMetronomeEnabled() const {
+    return metronome;
+}
+
+bool Preferences::isWaveformShown() const {
+    return showWaveform;
+}
+
 bool Preferences::isDarkTheme() const {
     return darkTheme;
 }
@@ -164,6 +223,10 @@ bool Preferences::getCopyArtAndMusic() const {
     return copyArtAndMusic;
 }
 
+size_t Preferences::getUndoHistoryBytes() const {
+    return static_cast<size_t>(undoHistoryMB) * 1024 * 1024;
+}
+
 std::string Preferences::getInputDir() const {
     return inputDir;
 }
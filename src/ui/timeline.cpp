@@ -2,6 +2,7 @@
 
 #include "actions/deleteitems.hpp"
 #include "actions/deletenote.hpp"
+#include "actions/deleteselection.hpp"
 #include "actions/editnote.hpp"
 #include "actions/editskip.hpp"
 #include "actions/flipnote.hpp"
@@ -9,15 +10,20 @@
 #include "actions/placenote.hpp"
 #include "actions/placestop.hpp"
 #include "actions/placeskip.hpp"
+#include "actions/quantizenotes.hpp"
 #include "actions/shiftnote.hpp"
 
 #include "config/constants.hpp"
 #include "config/notemaps.hpp"
 #include "config/utils.hpp"
+#include "systems/profiler.hpp"
 #include "ui/preferences.hpp"
 
 #include "ImGuiFileDialog.h"
 
+#include <cmath>
+#include <set>
+
 namespace utils {
 
 int filterInputMiddleKey(ImGuiInputTextCallbackData * data) {
@@ -43,6 +49,12 @@ void updateAudioPosition(AudioSystem * audioSystem, const SongPosition & songpos
     }
 }
 
+void scrubAudioPosition(AudioSystem * audioSystem, const SongPosition & songpos, int musicSourceIdx) {
+    if(Preferences::Instance().isAudioScrubbed() && !audioSystem->isMusicPlaying(musicSourceIdx)) {
+        audioSystem->scrubMusic(musicSourceIdx, static_cast<float>(songpos.absTime + (songpos.offsetMS / 1000.0)));
+    }
+}
+
 } // namespace utils
 
 void Timeline::showContents(int musicSourceIdx, bool focused, bool & unsaved, AudioSystem * audioSystem,
@@ -52,6 +64,7 @@ void Timeline::showContents(int musicSourceIdx, bool focused, bool & unsaved, Au
     showCurrentBeat(musicSourceIdx, chartinfo, songpos, audioSystem);
     showBeatpos(songpos);
     showZoom(focused);
+    showMinimap(musicSourceIdx, chartinfo, songpos, audioSystem);
     showSequencer(focused, chartinfo, songpos);
 
     checkResetClicks();
@@ -60,8 +73,8 @@ void Timeline::showContents(int musicSourceIdx, bool focused, bool & unsaved, Au
     std::string addItemPopup { constants::ADD_ITEM_POPUP_PREFIX + std::to_string(musicSourceIdx) };
 
     // insert or update entity at the clicked beat
-    prepUpdateEntity(focused, addItemPopup, songpos);
-    setEntityType(focused, addItemPopup, songpos);
+    prepUpdateEntity(focused, addItemPopup, chartinfo, songpos);
+    setEntityType(focused, addItemPopup, chartinfo, songpos);
 
     checkEditActions(focused, unsaved, chartinfo, songpos, keysPressed);
 
@@ -145,8 +158,88 @@ void Timeline::showZoom(bool focused) {
     zoom = ImMax(zoom, constants::ZOOM_STEP);
 }
 
+void Timeline::showMinimap(int musicSourceIdx, ChartInfo & chartinfo, SongPosition & songpos, AudioSystem * audioSystem) const {
+    auto & density { chartinfo.notes.density };
+
+    // the whole song, or up to the last item if the chart runs past the music
+    double songBeats { static_cast<double>(density.getBucketCount()) * NoteDensity::BUCKET_BEATS };
+    if(!songpos.timeinfo.empty()) {
+        double musicEndTime { audioSystem->getMusicLength(musicSourceIdx) - songpos.offsetMS / 1000.0 };
+        songBeats = std::max(songBeats, utils::calculateAbsBeat(musicEndTime, songpos.timeinfo));
+    }
+
+    ImVec2 pos { ImGui::GetCursorScreenPos() };
+    ImVec2 size { ImGui::GetContentRegionAvail().x, constants::MINIMAP_LANE_HEIGHT * NoteDensity::NUM_LANES };
+    ImGui::InvisibleButton("##minimap", ImVec2(std::max(size.x, 1.f), size.y));
+
+    if(songBeats <= 0.0 || size.x < 1.f) {
+        return;
+    }
+
+    auto drawList { ImGui::GetWindowDrawList() };
+    drawList->AddRectFilled(pos, ImVec2(pos.x + size.x, pos.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    // one pixel column per step, shaded by the fullest bucket it covers
+    int maxCount { density.getMaxCount() };
+    double bucketsPerColumn { songBeats / NoteDensity::BUCKET_BEATS / size.x };
+    for(int column = 0; column < static_cast<int>(size.x) && maxCount > 0; column++) {
+        auto firstBucket { static_cast<size_t>(column * bucketsPerColumn) };
+        auto lastBucket { std::max(firstBucket + 1, static_cast<size_t>((column + 1) * bucketsPerColumn)) };
+        if(firstBucket >= density.getBucketCount()) {
+            break;
+        }
+
+        for(size_t lane = 0; lane < NoteDensity::NUM_LANES; lane++) {
+            int peak { 0 };
+            for(size_t bucket = firstBucket; bucket < lastBucket; bucket++) {
+                peak = std::max(peak, density.getCount(lane, bucket));
+            }
+
+            if(peak > 0) {
+                float alpha { .25f + .75f * static_cast<float>(peak) / static_cast<float>(maxCount) };
+                float y { pos.y + lane * constants::MINIMAP_LANE_HEIGHT };
+                drawList->AddRectFilled(ImVec2(pos.x + column, y), ImVec2(pos.x + column + 1, y + constants::MINIMAP_LANE_HEIGHT),
+                    ImGui::GetColorU32(ImGuiCol_PlotHistogram, alpha));
+            }
+        }
+    }
+
+    // the sequencer's view as of its last draw
+    const auto & notes { chartinfo.notes };
+    float viewStartX { pos.x + static_cast<float>(std::clamp(notes.viewFirstBeat / songBeats, 0.0, 1.0)) * size.x };
+    float viewEndX { pos.x + static_cast<float>(std::clamp(notes.viewLastBeat / songBeats, 0.0, 1.0)) * size.x };
+    drawList->AddRectFilled(ImVec2(viewStartX, pos.y), ImVec2(std::max(viewEndX, viewStartX + 1.f), pos.y + size.y), ImGui::GetColorU32(ImGuiCol_Text, .15f));
+    drawList->AddRect(ImVec2(viewStartX, pos.y), ImVec2(std::max(viewEndX, viewStartX + 1.f), pos.y + size.y), ImGui::GetColorU32(ImGuiCol_Text, .6f));
+
+    // click or drag to seek
+    const auto & io = ImGui::GetIO();
+    if(ImGui::IsItemActive() && (ImGui::IsItemActivated() || io.MouseDelta.x != 0.f)) {
+        double targetBeat { std::clamp((io.MousePos.x - pos.x) / size.x, 0.f, 1.f) * songBeats };
+        targetBeat = std::round(targetBeat / currentBeatsplitValue) * currentBeatsplitValue;
+
+        if(!songpos.started) {
+            songpos.start();
+            songpos.pause();
+            songpos.pauseCounter += static_cast<Uint64>((songpos.offsetMS / 1000.0) * static_cast<double>(SDL_GetPerformanceFrequency()));
+        }
+
+        songpos.setSongBeatPosition(targetBeat);
+
+        if(songpos.absTime >= 0) {
+            utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+        } else {
+            songpos.setSongBeatPosition(0);
+        }
+
+        chartinfo.notes.resetPassed(songpos.absBeat);
+    }
+}
+
 void Timeline::showSequencer(bool focused, ChartInfo & chartinfo, SongPosition & songpos) {
+    PROFILE_SCOPE(SEQUENCER);
+
     rightClickedEntity = false;
+    chartinfo.notes.setSelection(&selection);
 
     int beatsPerMeasure = songpos.timeinfo.size() > songpos.currentSection ? songpos.timeinfo.at(songpos.currentSection).beatsPerMeasure : 4;
     ImSequencer::Sequencer(&(chartinfo.notes), zoom, currentBeatsplit, beatsPerMeasure, Preferences::Instance().isDarkTheme(), haveSelection, focused,
@@ -174,6 +267,7 @@ void Timeline::checkUpdatedBeat(bool focused, int musicSourceIdx, ChartInfo & ch
 
         if(songpos.absTime >= 0) {
             utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+            utils::scrubAudioPosition(audioSystem, songpos, musicSourceIdx);
         } else {
             songpos.setSongBeatPosition(0);
         }
@@ -182,11 +276,27 @@ void Timeline::checkUpdatedBeat(bool focused, int musicSourceIdx, ChartInfo & ch
     }
 }
 
-void Timeline::prepUpdateEntity(bool focused, const std::string & addItemPopup, const SongPosition & songpos) {
+void Timeline::prepUpdateEntity(bool focused, const std::string & addItemPopup, const ChartInfo & chartinfo, const SongPosition & songpos) {
     if(focused && !ImGuiFileDialog::Instance()->IsOpened() && leftClickedEntity && !ImGui::IsPopupOpen(addItemPopup.c_str())) {
-        bool hadSelection = haveSelection;
-        if(haveSelection) {
-            haveSelection = false;
+        const auto & io = ImGui::GetIO();
+
+        // ctrl-click toggles a single item, alt-click picks every note of its key
+        if(!leftClickShift && (io.KeyCtrl || io.KeyAlt)) {
+            auto clickedItem { chartinfo.notes.containsItemAt(clickedBeat, static_cast<NoteSequenceItem::SequencerItemType>(clickedItemType)) };
+            if(clickedItem && io.KeyCtrl) {
+                selection.toggle(clickedItem);
+            } else if(clickedItem && clickedItem->itemType <= NoteSequenceItem::SequencerItemType::BOT_NOTE) {
+                selection.add(chartinfo.notes.getKeyItems(clickedItem->displayText));
+            }
+
+            leftClickedEntity = false;
+            return;
+        }
+
+        bool hadSelection = haveSelection || !selection.empty();
+        haveSelection = false;
+        if(!leftClickShift) {
+            selection.clear();
         }
 
         if(!hadSelection || leftClickShift) {
@@ -217,10 +327,13 @@ void Timeline::prepUpdateEntity(bool focused, const std::string & addItemPopup,
     }
 }
 
-void Timeline::setEntityType(bool focused, const std::string & addItemPopup, const SongPosition & songpos) {
+void Timeline::setEntityType(bool focused, const std::string & addItemPopup, const ChartInfo & chartinfo, const SongPosition & songpos) {
     if(focused && !ImGuiFileDialog::Instance()->IsOpened() && startedNote && leftClickReleased &&
         !ImGui::IsPopupOpen(addItemPopup.c_str()) && clickedBeat >= insertBeat)
     {
+        endBeat = clickedBeat;
+        endBeatpos = utils::calculateBeatpos(endBeat, currentBeatsplit, songpos.timeinfo);
+
         if(leftClickShift) {
             haveSelection = true;
 
@@ -231,12 +344,22 @@ void Timeline::setEntityType(bool focused, const std::string & addItemPopup, con
             } else {
                 insertItemTypeEnd = releasedItemType;
             }
+
+            // a plain range replaces the selection, ctrl adds to it and alt takes away from it
+            const auto & io = ImGui::GetIO();
+            auto rangeItems { chartinfo.notes.getItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd) };
+            if(io.KeyAlt) {
+                selection.remove(rangeItems);
+            } else {
+                if(!io.KeyCtrl) {
+                    selection.clear();
+                }
+
+                selection.add(rangeItems);
+            }
         } else {
             ImGui::OpenPopup(addItemPopup.c_str());
         }
-        
-        endBeat = clickedBeat;
-        endBeatpos = utils::calculateBeatpos(endBeat, currentBeatsplit, songpos.timeinfo);
 
         leftClickReleased = false;
         leftClickShift = false;
@@ -247,14 +370,20 @@ void Timeline::setEntityType(bool focused, const std::string & addItemPopup, con
 void Timeline::checkEditActions(bool focused, bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos, std::vector<bool> & keysPressed) {
     const auto & io = ImGui::GetIO();
 
+    if(focused && (activateSelectAll || (io.KeyCtrl && keysPressed[SDL_GetScancodeFromKey(SDLK_a)]))) {
+        editSelectAll(chartinfo);
+    }
+
     // copy, cut, delete selection of notes
-    if(focused && haveSelection) {
+    if(focused && !selection.empty()) {
         if(activateCopy || (io.KeyCtrl && keysPressed[SDL_GetScancodeFromKey(SDLK_c)])) {
             editCopy(chartinfo);
         } else if(activateCut || (io.KeyCtrl && keysPressed[SDL_GetScancodeFromKey(SDLK_x)])) {
             editCut(unsaved, chartinfo);
         } else if(activateFlip || keysPressed[SDL_GetScancodeFromKey(SDLK_f)]) {
             editFlip(unsaved, chartinfo);
+        } else if(activateQuantize || keysPressed[SDL_GetScancodeFromKey(SDLK_q)]) {
+            editQuantize(unsaved, chartinfo, songpos);
         }
 
         editShiftNotes(unsaved, chartinfo, keysPressed);
@@ -262,46 +391,54 @@ void Timeline::checkEditActions(bool focused, bool & unsaved, ChartInfo & charti
         if(keysPressed[SDL_SCANCODE_DELETE]) {
             editDelete(unsaved, chartinfo);
         }
+    }
 
-        if(keysPressed[SDL_SCANCODE_ESCAPE]) {
-            haveSelection = false;
-        }
+    if(focused && (haveSelection || !selection.empty()) && keysPressed[SDL_SCANCODE_ESCAPE]) {
+        clearSelection();
     }
 
     if(focused && (activatePaste || (io.KeyCtrl && keysPressed[SDL_GetScancodeFromKey(SDLK_v)]))) {
         editPaste(unsaved, chartinfo, songpos);
     }
+
+    // menu requests without a selection to apply to are dropped
+    activateCopy = false;
+    activateCut = false;
+    activateFlip = false;
+    activateQuantize = false;
 }
 
 
 void Timeline::editCopy(const ChartInfo & chartinfo) {
-    copiedItems = chartinfo.notes.getItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd);
-    haveSelection = false;
+    copiedItems = selection.getItems();
+    copiedItemTypeStart = selection.getMinItemType();
+    copiedItemTypeEnd = selection.getMaxItemType();
+
+    clearSelection();
     activateCopy = false;
 }
 
 void Timeline::editCut(bool & unsaved, ChartInfo & chartinfo) {
-    copiedItems = chartinfo.notes.getItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd);
-    chartinfo.notes.deleteItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd);
+    editCopy(chartinfo);
+    chartinfo.notes.deleteItems(copiedItems);
 
     if(!copiedItems.empty()) {
-        auto delAction { std::make_shared<DeleteItemsAction>(insertItemType, insertItemTypeEnd, insertBeat, endBeat, copiedItems) };
-        undoStack.push(delAction);
-        utils::emptyActionStack(redoStack);
+        auto delAction { std::make_shared<DeleteSelectionAction>(copiedItems) };
+        pushAction(delAction);
 
         unsaved = true;
     }
 
-    haveSelection = false;
     activateCut = false;
 }
 
 void Timeline::editFlip(bool & unsaved, ChartInfo & chartinfo) {
-    auto flipAction { std::make_shared<FlipNoteAction>(insertItemType, insertItemTypeEnd, insertBeat, endBeat, chartinfo.keyboardLayout) };
-    undoStack.push(flipAction);
-    utils::emptyActionStack(redoStack);
+    auto items { selection.getItems() };
 
-    chartinfo.notes.flipNotes(chartinfo.keyboardLayout, insertBeat, endBeat, insertItemType, insertItemTypeEnd);
+    auto flipAction { std::make_shared<FlipNoteAction>(chartinfo.keyboardLayout, items) };
+    pushAction(flipAction);
+
+    chartinfo.notes.flipItems(chartinfo.keyboardLayout, items);
     unsaved = true;
     activateFlip = false;
 }
@@ -320,46 +457,45 @@ void Timeline::editShiftNotes(bool & unsaved, ChartInfo & chartinfo, const std::
     }
 
     if(shiftDirection != ShiftNoteAction::ShiftDirection::ShiftNone) {
-        auto items { chartinfo.notes.shiftNotes(chartinfo.keyboardLayout, insertBeat, endBeat, insertItemType, insertItemTypeEnd, shiftDirection) };
+        double firstBeat { selection.getFirstBeat() };
+        double lastBeat { selection.getLastBeat() };
+        auto items { chartinfo.notes.shiftItems(chartinfo.keyboardLayout, firstBeat, lastBeat, selection.getItems(), shiftDirection) };
 
-        auto shiftAction { std::make_shared<ShiftNoteAction>(insertItemType, insertItemTypeEnd, insertBeat, endBeat, 
+        auto shiftAction { std::make_shared<ShiftNoteAction>(selection.getMinItemType(), selection.getMaxItemType(), firstBeat, lastBeat,
             chartinfo.keyboardLayout, shiftDirection, items) };
-        undoStack.push(shiftAction);
-        utils::emptyActionStack(redoStack);
+        pushAction(shiftAction);
 
         unsaved = true;
     }
 }
 
 void Timeline::editDelete(bool & unsaved, ChartInfo & chartinfo) {
-    auto deletedItems = chartinfo.notes.getItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd);
-    chartinfo.notes.deleteItems(insertBeat, endBeat, insertItemType, insertItemTypeEnd);
+    auto deletedItems { selection.getItems() };
+    chartinfo.notes.deleteItems(deletedItems);
 
     if(!deletedItems.empty()) {
-        auto delAction { std::make_shared<DeleteItemsAction>(insertItemType, insertItemTypeEnd, insertBeat, endBeat, deletedItems) };
-        undoStack.push(delAction);
-        utils::emptyActionStack(redoStack);
+        auto delAction { std::make_shared<DeleteSelectionAction>(deletedItems) };
+        pushAction(delAction);
 
         unsaved = true;
     }
 
-    haveSelection = false;
+    clearSelection();
 }
 
 void Timeline::editPaste(bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos) {
     if(!copiedItems.empty()) {
         double hoveredBeatEnd { hoveredBeat + (copiedItems.back()->beatEnd - copiedItems.front()->absBeat) };
-        auto overwrittenItems { chartinfo.notes.getItems(hoveredBeat, hoveredBeatEnd, insertItemType, insertItemTypeEnd) };
-        chartinfo.notes.insertItems(hoveredBeat, songpos.absBeat, insertItemType, insertItemTypeEnd, songpos.timeinfo, copiedItems);
+        auto overwrittenItems { chartinfo.notes.getItems(hoveredBeat, hoveredBeatEnd, copiedItemTypeStart, copiedItemTypeEnd) };
+        chartinfo.notes.insertItems(hoveredBeat, songpos.absBeat, copiedItemTypeStart, copiedItemTypeEnd, songpos.timeinfo, copiedItems);
 
         if(!overwrittenItems.empty()) {
-            auto delAction { std::make_shared<DeleteItemsAction>(insertItemType, insertItemTypeEnd, hoveredBeat, hoveredBeatEnd, overwrittenItems) };
-            undoStack.push(delAction);
+            auto delAction { std::make_shared<DeleteItemsAction>(copiedItemTypeStart, copiedItemTypeEnd, hoveredBeat, hoveredBeatEnd, overwrittenItems) };
+            pushAction(delAction);
         }
 
-        auto insAction { std::make_shared<InsertItemsAction>(insertItemType, insertItemTypeEnd, hoveredBeat, copiedItems, overwrittenItems) };
-        undoStack.push(insAction);
-        utils::emptyActionStack(redoStack);
+        auto insAction { std::make_shared<InsertItemsAction>(copiedItemTypeStart, copiedItemTypeEnd, hoveredBeat, copiedItems, overwrittenItems) };
+        pushAction(insAction);
 
         unsaved = true;
     }
@@ -367,6 +503,62 @@ void Timeline::editPaste(bool & unsaved, ChartInfo & chartinfo, const SongPositi
     activatePaste = false;
 }
 
+void Timeline::editSelectAll(const ChartInfo & chartinfo) {
+    selection.clear();
+    selection.add(std::list<std::shared_ptr<NoteSequenceItem>>(chartinfo.notes.myItems.begin(), chartinfo.notes.myItems.end()));
+
+    activateSelectAll = false;
+}
+
+void Timeline::editQuantize(bool & unsaved, ChartInfo & chartinfo, const SongPosition & songpos) {
+    // snaps selected notes to the current beatsplit; stops and skips change the timing, so they stay put
+    std::vector<QuantizeNotesAction::Move> moves;
+    std::set<std::pair<double, NoteSequenceItem::SequencerItemType>> claimedBeats;
+
+    for(const auto & item : selection.getItems()) {
+        if(item->itemType > NoteSequenceItem::SequencerItemType::BOT_NOTE) {
+            continue;
+        }
+
+        double toBeat { std::round(item->absBeat / currentBeatsplitValue) * currentBeatsplitValue };
+        if(toBeat == item->absBeat) {
+            continue;
+        }
+
+        // a note already on the target, or another note snapped there, wins
+        auto existingItem { chartinfo.notes.getItemAt(toBeat, item->itemType) };
+        if((existingItem && existingItem != item) || !claimedBeats.insert({ toBeat, item->itemType }).second) {
+            continue;
+        }
+
+        double toBeatEnd { toBeat + (item->beatEnd - item->absBeat) };
+        moves.push_back({ item, item->absBeat, item->beatEnd, item->beatpos, item->endBeatpos, toBeat, toBeatEnd,
+            utils::calculateBeatpos(toBeat, currentBeatsplit, songpos.timeinfo), utils::calculateBeatpos(toBeatEnd, currentBeatsplit, songpos.timeinfo) });
+    }
+
+    if(!moves.empty()) {
+        for(const auto & move : moves) {
+            chartinfo.notes.moveItem(move.item, move.toBeat, move.toBeatEnd, move.toBeatpos, move.toEndBeatpos);
+        }
+
+        chartinfo.notes.sortItems();
+        chartinfo.notes.resetPassed(songpos.absBeat);
+        selection.sort();
+
+        auto quantizeAction { std::make_shared<QuantizeNotesAction>(moves) };
+        pushAction(quantizeAction);
+
+        unsaved = true;
+    }
+
+    activateQuantize = false;
+}
+
+void Timeline::clearSelection() {
+    haveSelection = false;
+    selection.clear();
+}
+
 void Timeline::showAddItem(bool & unsaved, ChartInfo & chartinfo, SongPosition & songpos, std::vector <bool> & keysPressed) {
     static char addedItem[2];
 
@@ -415,8 +607,7 @@ void Timeline::showTopMidNote(bool & unsaved, char * addedItem, ChartInfo & char
                 currAction = std::make_shared<PlaceNoteAction>(insertBeat, beatDuration, insertBeatpos, endBeatpos, itemType, keyText);
             }
 
-            undoStack.push(currAction);
-            utils::emptyActionStack(redoStack);
+            pushAction(currAction);
 
             addedItem[0] = '\0';
             ImGui::CloseCurrentPopup();
@@ -459,8 +650,7 @@ void Timeline::showBotNote(bool & unsaved, ChartInfo & chartinfo, const SongPosi
         currAction = std::make_shared<PlaceNoteAction>(insertBeat, beatDuration, insertBeatpos, endBeatpos, itemType, keyText);
     }
 
-    undoStack.push(currAction);
-    utils::emptyActionStack(redoStack);
+    pushAction(currAction);
 
     ImGui::CloseCurrentPopup();
 
@@ -512,8 +702,7 @@ void Timeline::showSkip(bool & unsaved, ChartInfo & chartinfo, SongPosition & so
             songpos.addSkip(newSkip);
         }
 
-        undoStack.push(currAction);
-        utils::emptyActionStack(redoStack);
+        pushAction(currAction);
 
         ImGui::CloseCurrentPopup();
         unsaved = true;
@@ -526,8 +715,7 @@ void Timeline::showStop(bool & unsaved, ChartInfo & chartinfo, const SongPositio
     chartinfo.notes.addStop(insertBeat, songpos.absBeat, endBeat - insertBeat, insertBeatpos, endBeatpos);
 
     auto putAction { std::make_shared<PlaceStopAction>(insertBeat, endBeat - insertBeat, insertBeatpos, endBeatpos) };
-    undoStack.push(putAction);
-    utils::emptyActionStack(redoStack);
+    pushAction(putAction);
 
     ImGui::CloseCurrentPopup();
     unsaved = true;
@@ -541,8 +729,7 @@ void Timeline::checkDeleteItem(bool focused, bool & unsaved, ChartInfo & chartin
             chartinfo.notes.deleteItem(clickedBeat, static_cast<NoteSequenceItem::SequencerItemType>(clickedItemType));
             auto deleteAction { std::make_shared<DeleteNoteAction>(itemToDelete->absBeat, itemToDelete->beatEnd - itemToDelete->absBeat,
                 itemToDelete->beatpos, itemToDelete->endBeatpos, itemToDelete->itemType, itemToDelete->displayText) };
-            undoStack.push(deleteAction);
-            utils::emptyActionStack(redoStack);
+            pushAction(deleteAction);
 
             unsaved = true;
 
@@ -556,7 +743,9 @@ void Timeline::checkDeleteItem(bool focused, bool & unsaved, ChartInfo & chartin
 void Timeline::checkUpdateNotes(bool focused, AudioSystem * audioSystem, ChartInfo & chartinfo, const SongPosition & songpos) {
     // update notes
     if(focused) {
-        chartinfo.notes.update(songpos.absBeat, audioSystem, Preferences::Instance().isNotesoundEnabled());
+        // mixed notesounds are already part of the music stream
+        bool notesoundEnabled { Preferences::Instance().isNotesoundEnabled() && !Preferences::Instance().isNotesoundMixed() };
+        chartinfo.notes.update(songpos.absBeat, audioSystem, notesoundEnabled);
     }
 }
 
@@ -598,6 +787,7 @@ void Timeline::showHorizontalScroll(bool focused, int musicSourceIdx, ChartInfo
 
         if(songpos.absTime >= 0) {
             utils::updateAudioPosition(audioSystem, songpos, musicSourceIdx);
+            utils::scrubAudioPosition(audioSystem, songpos, musicSourceIdx);
         } else {
             audioSystem->stopMusic(musicSourceIdx);
             songpos.stop();
@@ -607,10 +797,23 @@ void Timeline::showHorizontalScroll(bool focused, int musicSourceIdx, ChartInfo
     }
 }
 
+void Timeline::pushAction(const std::shared_ptr<EditAction> & action) {
+    history.push(action, Preferences::Instance().getUndoHistoryBytes());
+}
+
 int Timeline::getUndoStackSize() const {
-    return static_cast<int>(undoStack.size());
+    return static_cast<int>(history.getUndoCount());
 }
 
 int Timeline::getRedoStackSize() const {
-    return static_cast<int>(redoStack.size());
+    return static_cast<int>(history.getRedoCount());
+}
+
+size_t Timeline::getHistoryMemoryUsage() const {
+    return history.getMemoryUsage();
+}
+
+size_t Timeline::getClipboardMemoryUsage() const {
+    // the selection only holds handles, so it is counted along with the copied items
+    return NoteSequence::getItemsMemoryUsage(copiedItems) + selection.getMemoryUsage();
 }